@@ -0,0 +1,745 @@
+/**
+ * @file cpp_benchmark.cpp
+ * @author Pascal Enderli
+ * @date 2026.10.18
+ * @brief Micro benchmarks for the IniBuffer class.
+ */
+
+#include"ini_buffer.h"
+#include<atomic>
+#include<memory>
+#include<chrono>
+#include<cstdio>
+#include<cstdlib>
+#include<cstring>
+#include<fstream>
+#include<new>
+#include<random>
+#include<sstream>
+#include<string>
+#include<thread>
+#include<vector>
+
+//-----------------------------------------------------------------------------------
+// Allocation counter
+
+/// Number of heap allocations of the whole process.
+static std::atomic<size_t> allocation_count(0);
+
+#if defined(__GNUC__)
+    /// Keeps the replaced operators out of line, so the compiler does not pair the inlined free() with new.
+    #define INI_BENCHMARK_NOINLINE __attribute__((noinline))
+#else
+    #define INI_BENCHMARK_NOINLINE
+#endif
+
+/// Allocates memory from malloc and counts the allocation.
+static void* CountedAllocate(size_t size)
+{
+    ++allocation_count;
+    void* memory = std::malloc(size == 0 ? 1 : size);
+    if(memory == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+INI_BENCHMARK_NOINLINE void* operator new(size_t size)
+{
+    return CountedAllocate(size);
+}
+
+INI_BENCHMARK_NOINLINE void* operator new[](size_t size)
+{
+    return CountedAllocate(size);
+}
+
+INI_BENCHMARK_NOINLINE void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+INI_BENCHMARK_NOINLINE void operator delete[](void* memory) noexcept
+{
+    std::free(memory);
+}
+
+INI_BENCHMARK_NOINLINE void operator delete(void* memory, size_t) noexcept
+{
+    std::free(memory);
+}
+
+INI_BENCHMARK_NOINLINE void operator delete[](void* memory, size_t) noexcept
+{
+    std::free(memory);
+}
+
+//-----------------------------------------------------------------------------------
+// Results
+
+/// One reported measurement. Values which were not measured are negative.
+struct Result
+{
+    std::string group;
+    std::string name;
+    double ns_per_op;
+    double mb_per_s;
+    double allocations_per_op;
+};
+
+/// All reported measurements, written by WriteJson.
+static std::vector<Result> results;
+
+/// Group of the following results, set by BeginGroup.
+static std::string current_group;
+
+/// Prints the title of a group of benchmarks. Following results are recorded as part of the group.
+void BeginGroup(const std::string& group, const std::string& details = std::string())
+{
+    current_group = group;
+    std::cout<<group<<(details.empty() ? "" : " ")<<details<<'\n';
+}
+
+/// Records a measurement under the current group. Leading and trailing blanks of the printed name are removed.
+void Record(const std::string& name, double ns_per_op, double mb_per_s, double allocations_per_op)
+{
+    const size_t begin = name.find_first_not_of(' ');
+    const size_t end = name.find_last_not_of(' ');
+    results.push_back(Result{current_group, begin == std::string::npos ? name : name.substr(begin, end - begin + 1), ns_per_op, mb_per_s, allocations_per_op});
+}
+
+/// Writes a string as JSON string literal.
+void WriteJsonString(std::ostream& stream, const std::string& str)
+{
+    stream<<'"';
+    for(char c : str)
+    {
+        if(c == '"' || c == '\\')
+        {
+            stream<<'\\';
+        }
+        stream<<c;
+    }
+    stream<<'"';
+}
+
+/// Writes all recorded measurements as JSON, e.g. for regression tracking or as baseline of the python benchmark.
+void WriteJson(const std::string& fullfilename)
+{
+    std::ofstream file(fullfilename, std::ios::out | std::ios::binary);
+    if(!file)
+    {
+        throw INI_EXCEPTION("Could not open the JSON output: " + fullfilename);
+    }
+
+    file<<"{\n  \"benchmarks\": [";
+    for(size_t i = 0; i < results.size(); ++i)
+    {
+        const Result& result = results[i];
+        file<<(i == 0 ? "\n" : ",\n")<<"    {\"group\": ";
+        WriteJsonString(file, result.group);
+        file<<", \"name\": ";
+        WriteJsonString(file, result.name);
+        file<<", \"ns_per_op\": "<<result.ns_per_op;
+        if(result.mb_per_s >= 0)
+        {
+            file<<", \"mb_per_s\": "<<result.mb_per_s;
+        }
+        if(result.allocations_per_op >= 0)
+        {
+            file<<", \"allocs_per_op\": "<<result.allocations_per_op;
+        }
+        file<<"}";
+    }
+    file<<"\n  ]\n}\n";
+}
+
+//-----------------------------------------------------------------------------------
+// Helpers
+
+/// Runs a function a given number of times and returns the average time per call in nanoseconds.
+template<typename FunctionT>
+double MeasureNs(size_t iterations, FunctionT function)
+{
+    auto start = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < iterations; ++i)
+    {
+        function();
+    }
+    auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(stop - start).count()/iterations;
+}
+
+/// Runs a function a given number of times and returns the average number of heap allocations per call.
+template<typename FunctionT>
+double CountAllocations(size_t iterations, FunctionT function)
+{
+    size_t start = allocation_count;
+    for(size_t i = 0; i < iterations; ++i)
+    {
+        function();
+    }
+    return static_cast<double>(allocation_count - start)/iterations;
+}
+
+/// Prints a benchmark result in the format <name>: <ns> ns/op
+void Report(const std::string& name, double ns_per_op)
+{
+    std::cout<<name<<": "<<ns_per_op<<" ns/op\n";
+    Record(name, ns_per_op, -1, -1);
+}
+
+/// Prints a benchmark result in the format <name>: <us> us/op, <throughput> MB/s
+void ReportThroughput(const std::string& name, double ns_per_op, size_t bytes_per_op)
+{
+    const double mb_per_s = (bytes_per_op/(ns_per_op*1e-9))/(1024*1024);
+    std::cout<<name<<": "<<ns_per_op/1000<<" us/op, "<<mb_per_s<<" MB/s\n";
+    Record(name, ns_per_op, mb_per_s, -1);
+}
+
+/// Prints a benchmark result in the format <name>: <ns> ns/op, <allocations> allocs/op
+void Report(const std::string& name, double ns_per_op, double allocations_per_op)
+{
+    std::cout<<name<<": "<<ns_per_op<<" ns/op, "<<allocations_per_op<<" allocs/op\n";
+    Record(name, ns_per_op, -1, allocations_per_op);
+}
+
+//-----------------------------------------------------------------------------------
+// Arena allocator
+
+/// Monotonic arena. Allocations are never freed individually, Reset() reuses all blocks at once.
+class Arena
+{
+    public:
+
+    /// Returns the arena shared by all ArenaAllocators.
+    static Arena& Get() noexcept
+    {
+        static Arena arena;
+        return arena;
+    }
+
+    void* Allocate(size_t size, size_t alignment)
+    {
+        size_t offset = (used_ + alignment - 1) & ~(alignment - 1);
+        if(blocks_.empty() || offset + size > block_size)
+        {
+            if(size > block_size)
+            {
+                throw std::bad_alloc();
+            }
+            if(!blocks_.empty())
+            {
+                ++current_block_;
+            }
+            if(current_block_ == blocks_.size())
+            {
+                blocks_.emplace_back(new char[block_size]);
+            }
+            offset = 0;
+        }
+        used_ = offset + size;
+        return blocks_[current_block_].get() + offset;
+    }
+
+    /// Makes all blocks available again. Everything allocated before must not be used anymore.
+    void Reset() noexcept
+    {
+        current_block_ = 0;
+        used_ = 0;
+    }
+
+    private:
+
+    static constexpr size_t block_size = 1024*1024;
+
+    std::vector<std::unique_ptr<char[]>> blocks_;
+    size_t current_block_ = 0;
+    size_t used_ = 0;
+};
+
+constexpr size_t Arena::block_size;
+
+/// Allocator taking its memory from the shared Arena. Deallocation does nothing.
+template<typename ValueT>
+struct ArenaAllocator
+{
+    using value_type = ValueT;
+
+    ArenaAllocator() noexcept = default;
+
+    template<typename OtherT>
+    ArenaAllocator(const ArenaAllocator<OtherT>&) noexcept {}
+
+    ValueT* allocate(size_t count)
+    {
+        return static_cast<ValueT*>(Arena::Get().Allocate(count*sizeof(ValueT), alignof(ValueT)));
+    }
+
+    void deallocate(ValueT*, size_t) noexcept {}
+};
+
+template<typename ValueT, typename OtherT>
+bool operator==(const ArenaAllocator<ValueT>&, const ArenaAllocator<OtherT>&) noexcept {return true;}
+
+template<typename ValueT, typename OtherT>
+bool operator!=(const ArenaAllocator<ValueT>&, const ArenaAllocator<OtherT>&) noexcept {return false;}
+
+//-----------------------------------------------------------------------------------
+// Benchmarks
+
+/// Compares GetValue<std::string>, which copies the stored value, with GetStringRef.
+void BenchmarkStringAccess()
+{
+    const size_t iterations = 1000000;
+
+    IniBuffer ini;
+    ini.AddValue("strings", "short", std::string("red"));
+    ini.AddValue("strings", "long", std::string(256, 'x'));
+
+    size_t checksum = 0;
+    BeginGroup("String access");
+    for(const std::string key : {"short", "long"})
+    {
+        Report("  GetValue<std::string> " + key, MeasureNs(iterations, [&]()
+        {
+            checksum += ini.GetValue<std::string>("strings", key).size();
+        }));
+
+        Report("  GetStringRef          " + key, MeasureNs(iterations, [&]()
+        {
+            checksum += ini.GetStringRef("strings", key).size();
+        }));
+    }
+    std::cout<<"  (checksum "<<checksum<<")\n\n";
+}
+
+/// Compares lookups with literal names through the std::string overload and the C string overload.
+void BenchmarkKeyLookup()
+{
+    const size_t iterations = 1000000;
+
+    IniBuffer ini;
+    ini.LoadFile("data/performance.ini");
+    ini.AddValue("Circle of the benchmark", "Diameter of the circle", 700);
+
+    long long checksum = 0;
+    auto by_std_string = [&]()
+    {
+        checksum += ini.GetValue<int>(std::string("Circle of the benchmark"), std::string("Diameter of the circle"));
+    };
+    auto by_c_string = [&]()
+    {
+        checksum += ini.GetValue<int>("Circle of the benchmark", "Diameter of the circle");
+    };
+
+    BeginGroup("Key lookup with literal names");
+    Report("  GetValue<int>(std::string, std::string)", MeasureNs(iterations, by_std_string), CountAllocations(iterations, by_std_string));
+    Report("  GetValue<int>(const char*, const char*)", MeasureNs(iterations, by_c_string), CountAllocations(iterations, by_c_string));
+    std::cout<<"  (checksum "<<checksum<<")\n\n";
+}
+
+/// Compares parsing from disk with parsing from memory, which excludes the file I/O.
+void BenchmarkParse()
+{
+    const size_t iterations = 1000;
+    const std::string fullfilename = "data/performance.ini";
+
+    std::ifstream file(fullfilename, std::ios::in | std::ios::binary);
+    std::stringstream content_stream;
+    content_stream<<file.rdbuf();
+    const std::string content = content_stream.str();
+
+    size_t checksum = 0;
+    BeginGroup("Parse", fullfilename + " (" + std::to_string(content.size()) + " bytes)");
+    ReportThroughput("  LoadFile      ", MeasureNs(iterations, [&]()
+    {
+        IniBuffer ini;
+        ini.LoadFile(fullfilename);
+        checksum += ini.GetStringRef("section00", "key01").size();
+    }), content.size());
+
+    ReportThroughput("  LoadFromBuffer", MeasureNs(iterations, [&]()
+    {
+        IniBuffer ini;
+        ini.LoadFromBuffer(content.data(), content.size());
+        checksum += ini.GetStringRef("section00", "key01").size();
+    }), content.size());
+
+    ReportThroughput("  LoadFromStream", MeasureNs(iterations, [&]()
+    {
+        std::istringstream stream(content);
+        IniBuffer ini;
+        ini.LoadFromStream(stream);
+        checksum += ini.GetStringRef("section00", "key01").size();
+    }), content.size());
+
+    IniHandler handler;
+    ReportThroughput("  IniReader only", MeasureNs(iterations, [&]()
+    {
+        IniReader reader(handler);
+        reader.Read(content.data(), content.size());
+        reader.Finish();
+    }), content.size());
+    std::cout<<"  (checksum "<<checksum<<")\n\n";
+}
+
+/// Compares serializing into a new string with serializing into a reused buffer.
+void BenchmarkSerialize()
+{
+    const size_t iterations = 1000;
+
+    IniBuffer ini;
+    ini.LoadFile("data/performance.ini");
+
+    std::string buffer;
+    size_t checksum = 0;
+    auto to_string = [&]()
+    {
+        checksum += ini.WriteToString().size();
+    };
+    auto to_buffer = [&]()
+    {
+        ini.WriteToBuffer(buffer);
+        checksum += buffer.size();
+    };
+
+    BeginGroup("Serialize", "data/performance.ini");
+    Report("  WriteToString", MeasureNs(iterations, to_string), CountAllocations(iterations, to_string));
+    Report("  WriteToBuffer", MeasureNs(iterations, to_buffer), CountAllocations(iterations, to_buffer));
+    std::cout<<"  (checksum "<<checksum<<")\n\n";
+}
+
+/// Measures WriteFile of a large buffer with an increasing number of formatting threads.
+void BenchmarkParallelWrite()
+{
+    const size_t section_count = 4000;
+    const size_t keys_per_section = 250;
+    const size_t iterations = 3;
+    const std::string fullfilename = "results/parallel_write.ini";
+
+    IniBuffer ini;
+    for(size_t section = 0; section < section_count; ++section)
+    {
+        const std::string section_name = "section" + std::to_string(section);
+        for(size_t key = 0; key < keys_per_section; ++key)
+        {
+            ini.AddValue(section_name, "key" + std::to_string(key), "value of key " + std::to_string(key) + " in " + section_name);
+        }
+    }
+    const size_t size = ini.WriteToString().size();
+
+    BeginGroup("Parallel WriteFile", "(" + std::to_string(size/(1024*1024)) + " MB, " + std::to_string(std::thread::hardware_concurrency()) + " cores)");
+    for(size_t thread_count : {1, 2, 4, 8, 16})
+    {
+        ReportThroughput("  " + std::to_string(thread_count) + " threads", MeasureNs(iterations, [&]()
+        {
+            ini.WriteFile(fullfilename, false, thread_count);
+        }), size);
+    }
+    std::remove(fullfilename.c_str());
+    std::cout<<'\n';
+}
+
+/// Compares rewriting a large file with saving a change of one key.
+void BenchmarkSave()
+{
+    const size_t section_count = 1000;
+    const size_t keys_per_section = 100;
+    const size_t iterations = 20;
+    const std::string fullfilename = "results/save.ini";
+
+    IniBuffer ini;
+    for(size_t section = 0; section < section_count; ++section)
+    {
+        const std::string section_name = "section" + std::to_string(section);
+        for(size_t key = 0; key < keys_per_section; ++key)
+        {
+            ini.AddValue(section_name, "key" + std::to_string(key), "value of key " + std::to_string(key) + " in " + section_name);
+        }
+    }
+    ini.WriteFile(fullfilename, false);
+    ini.Clear();
+    ini.LoadFile(fullfilename);
+    const size_t size = ini.WriteToString().size();
+
+    size_t counter = 0;
+    BeginGroup("Save one changed key", "(" + std::to_string(size/1024) + " KB)");
+    Report("  WriteFile          ", MeasureNs(iterations, [&]()
+    {
+        ini.AddValue("section500", "key50", static_cast<int>(counter++ % 10));
+        ini.WriteFile(fullfilename, false);
+    }));
+    ini.Clear();
+    ini.LoadFile(fullfilename);
+    Report("  Save, same size    ", MeasureNs(iterations, [&]()
+    {
+        ini.AddValue("section500", "key50", static_cast<int>(counter++ % 10));
+        ini.Save();
+    }));
+    Report("  Save, size changed ", MeasureNs(iterations, [&]()
+    {
+        ini.AddValue("section500", "key50", static_cast<int>(counter++ % 2 == 0 ? 1 : 10));
+        ini.Save();
+    }));
+    std::remove(fullfilename.c_str());
+    std::cout<<'\n';
+}
+
+/// Parses, looks up and serializes the same content with one instantiation of BasicIniBuffer.
+template<typename BufferT, typename ResetFunctionT>
+void BenchmarkStorage(const std::string& name, const std::string& content, const std::vector<std::pair<std::string, std::string>>& lookups,
+                      ResetFunctionT reset_memory)
+{
+    const size_t parse_iterations = 100;
+
+    size_t checksum = 0;
+    auto parse = [&]()
+    {
+        reset_memory();
+        BufferT ini;
+        ini.LoadFromString(content);
+        checksum += ini.GetStringRef("section0", "key0").size();
+    };
+    const double parse_ns = MeasureNs(parse_iterations, parse);
+    const double parse_allocations = CountAllocations(parse_iterations, parse);
+
+    reset_memory();
+    BufferT ini;
+    ini.LoadFromString(content);
+
+    size_t i = 0;
+    const double lookup_ns = MeasureNs(lookups.size(), [&]()
+    {
+        checksum += ini.GetStringRef(lookups[i].first, lookups[i].second).size();
+        ++i;
+    });
+
+    std::string buffer;
+    const double serialize_ns = MeasureNs(parse_iterations, [&]()
+    {
+        ini.WriteToBuffer(buffer);
+        checksum += buffer.size();
+    });
+
+    // The results of each instantiation form a subgroup.
+    const std::string group = current_group;
+    current_group = group + "/" + name;
+    std::cout<<"  "<<name<<"\n";
+    Report("    LoadFromString", parse_ns, parse_allocations);
+    Report("    GetStringRef  ", lookup_ns);
+    Report("    WriteToBuffer ", serialize_ns);
+    current_group = group;
+    std::cout<<"    memory usage: "<<ini.GetMemoryUsage()<<" bytes (checksum "<<checksum<<")\n";
+}
+
+/// Compares the storage policies and an arena allocator on the same content and lookups.
+void BenchmarkStoragePolicies()
+{
+    const size_t section_count = 100;
+    const size_t keys_per_section = 100;
+    const size_t iterations = 1000000;
+
+    std::string content;
+    for(size_t section = 0; section < section_count; ++section)
+    {
+        content += "[section" + std::to_string(section) + "]\n";
+        for(size_t key = 0; key < keys_per_section; ++key)
+        {
+            content += "key" + std::to_string(key) + " = value of key " + std::to_string(key) + "\n";
+        }
+    }
+
+    std::mt19937 random_generator(42);
+    std::uniform_int_distribution<size_t> section_distribution(0, section_count - 1);
+    std::uniform_int_distribution<size_t> key_distribution(0, keys_per_section - 1);
+    std::vector<std::pair<std::string, std::string>> lookups;
+    for(size_t i = 0; i < iterations; ++i)
+    {
+        lookups.emplace_back("section" + std::to_string(section_distribution(random_generator)), "key" + std::to_string(key_distribution(random_generator)));
+    }
+
+    auto no_reset = [](){};
+    auto arena_reset = [](){Arena::Get().Reset();};
+
+    BeginGroup("Storage policies", "(" + std::to_string(section_count*keys_per_section) + " keys, " + std::to_string(content.size()) + " bytes)");
+    BenchmarkStorage<IniBuffer>("OrderedStorage", content, lookups, no_reset);
+    BenchmarkStorage<BasicIniBuffer<HashedStorage>>("HashedStorage", content, lookups, no_reset);
+    BenchmarkStorage<BasicIniBuffer<SortedVectorStorage>>("SortedVectorStorage", content, lookups, no_reset);
+    BenchmarkStorage<BasicIniBuffer<OrderedStorage, ArenaAllocator<char>>>("OrderedStorage with arena", content, lookups, arena_reset);
+    BenchmarkStorage<BasicIniBuffer<SortedVectorStorage, ArenaAllocator<char>>>("SortedVectorStorage with arena", content, lookups, arena_reset);
+    std::cout<<'\n';
+}
+
+/// Compares the default layout of a frozen buffer with a layout guided by an access profile under skewed (Zipfian) lookups.
+void BenchmarkProfileGuidedLayout()
+{
+    const size_t section_count = 100;
+    const size_t keys_per_section = 1000;
+    const size_t iterations = 1000000;
+
+    IniBuffer ini;
+    std::vector<std::pair<std::string, std::string>> names;
+    for(size_t section = 0; section < section_count; ++section)
+    {
+        for(size_t key = 0; key < keys_per_section; ++key)
+        {
+            names.emplace_back("section" + std::to_string(section), "key" + std::to_string(key));
+            ini.AddValue(names.back().first, names.back().second, "value of " + names.back().first + "/" + names.back().second);
+        }
+    }
+
+    // Zipfian popularity (s = 1) over the keys in random order.
+    std::mt19937 random_generator(42);
+    std::shuffle(names.begin(), names.end(), random_generator);
+    std::vector<double> cumulative_weights(names.size());
+    double weight_sum = 0;
+    for(size_t rank = 0; rank < names.size(); ++rank)
+    {
+        weight_sum += 1.0/(rank + 1);
+        cumulative_weights[rank] = weight_sum;
+    }
+    std::uniform_real_distribution<double> distribution(0, weight_sum);
+    std::vector<size_t> lookups(iterations);
+    for(size_t& lookup : lookups)
+    {
+        lookup = std::lower_bound(cumulative_weights.begin(), cumulative_weights.end(), distribution(random_generator)) - cumulative_weights.begin();
+    }
+
+    // Record the profile on the first half of the lookups.
+    ini.EnableAccessProfiling();
+    for(size_t i = 0; i < iterations/2; ++i)
+    {
+        ini.GetStringRef(names[lookups[i]].first, names[lookups[i]].second);
+    }
+    const FrozenIni map_order = ini.Freeze();
+    const FrozenIni profile_guided = ini.Freeze(ini.GetAccessReport());
+
+    size_t checksum = 0;
+    BeginGroup("Frozen layout with Zipfian lookups", "(" + std::to_string(names.size()) + " keys)");
+    for(const FrozenIni* frozen : {&map_order, &profile_guided})
+    {
+        size_t i = 0;
+        Report(frozen == &map_order ? "  map order     " : "  profile guided", MeasureNs(iterations, [&]()
+        {
+            const std::pair<std::string, std::string>& name = names[lookups[i++]];
+            checksum += frozen->GetStringView(name.first, name.second).size();
+        }));
+    }
+    std::cout<<"  (checksum "<<checksum<<")\n\n";
+}
+
+/// Compares reading a bound value with a lookup by name.
+void BenchmarkBoundValue()
+{
+    const size_t iterations = 1000000;
+
+    IniBuffer ini;
+    ini.LoadFile("data/performance.ini");
+    ini.AddValue("server", "max_conns", 64);
+    const IniBuffer::BoundValue<int> max_conns = ini.Bind<int>("server", "max_conns");
+
+    long long checksum = 0;
+    BeginGroup("Bound value");
+    Report("  GetValue<int>       ", MeasureNs(iterations, [&]()
+    {
+        checksum += ini.GetValue<int>("server", "max_conns");
+    }));
+    Report("  BoundValue<int>::Get", MeasureNs(iterations, [&]()
+    {
+        checksum += max_conns.Get();
+    }));
+    std::cout<<"  (checksum "<<checksum<<")\n\n";
+}
+
+/// Measures the overhead of access profiling on lookups.
+void BenchmarkAccessProfiling()
+{
+    const size_t iterations = 1000000;
+
+    IniBuffer ini;
+    ini.LoadFile("data/performance.ini");
+    ini.AddValue("server", "max_conns", 64);
+
+    long long checksum = 0;
+    auto lookup = [&]()
+    {
+        checksum += ini.GetValue<int>("server", "max_conns");
+    };
+
+    BeginGroup("Access profiling");
+    Report("  GetValue<int> not profiled", MeasureNs(iterations, lookup));
+    ini.EnableAccessProfiling();
+    Report("  GetValue<int> profiled    ", MeasureNs(iterations, lookup));
+    std::cout<<"  (checksum "<<checksum<<")\n\n";
+}
+
+/// Compares memory usage and lookup time of the IniBuffer with its frozen representation.
+void BenchmarkFrozen()
+{
+    const size_t iterations = 1000000;
+
+    IniBuffer ini;
+    ini.LoadFile("data/performance.ini");
+    ini.AddValue("Circle of the benchmark", "Diameter of the circle", 700);
+    const FrozenIni frozen = ini.Freeze();
+
+    const size_t property_count = frozen.GetPropertyCount();
+    BeginGroup("Frozen", "data/performance.ini (" + std::to_string(property_count) + " properties)");
+    std::cout<<"  IniBuffer: "<<ini.GetMemoryUsage()/property_count<<" bytes/key\n";
+    std::cout<<"  FrozenIni: "<<frozen.GetMemoryUsage()/property_count<<" bytes/key\n";
+
+    long long checksum = 0;
+    Report("  IniBuffer::GetValue<int>", MeasureNs(iterations, [&]()
+    {
+        checksum += ini.GetValue<int>("Circle of the benchmark", "Diameter of the circle");
+    }));
+    Report("  FrozenIni::GetValue<int>", MeasureNs(iterations, [&]()
+    {
+        checksum += frozen.GetValue<int>("Circle of the benchmark", "Diameter of the circle");
+    }));
+    std::cout<<"  (checksum "<<checksum<<")\n\n";
+}
+
+/// Runs all benchmarks. Usage: IniBufferBenchmarkApp [--json <fullfilename>]
+int main(int argc, char* argv[])
+{
+    try
+    {
+        std::string json_fullfilename;
+        if(argc == 3 && std::strcmp(argv[1], "--json") == 0)
+        {
+            json_fullfilename = argv[2];
+        }
+        else if(argc != 1)
+        {
+            std::cout<<"Usage: "<<argv[0]<<" [--json <fullfilename>]\n";
+            return 1;
+        }
+
+        BenchmarkStringAccess();
+        BenchmarkKeyLookup();
+        BenchmarkParse();
+        BenchmarkSerialize();
+        BenchmarkParallelWrite();
+        BenchmarkSave();
+        BenchmarkStoragePolicies();
+        BenchmarkFrozen();
+        BenchmarkProfileGuidedLayout();
+        BenchmarkBoundValue();
+        BenchmarkAccessProfiling();
+
+        if(!json_fullfilename.empty())
+        {
+            WriteJson(json_fullfilename);
+            std::cout<<"Results written to "<<json_fullfilename<<'\n';
+        }
+    }
+    catch(IniException& e)
+    {
+        std::cout<<e.what()<<'\n';
+        abort();
+    }
+    return 0;
+}
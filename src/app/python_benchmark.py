@@ -0,0 +1,352 @@
+#!/usr/bin/env python3
+# Benchmark suite of the python binding.
+# Every benchmark is calibrated to run for a minimum time per round and repeated for several rounds.
+# Statistics are printed and optionally written as JSON for regression tracking:
+#   python3 python_benchmark.py --json python_results.json
+# The C++ results of IniBufferBenchmarkApp --json cpp_results.json can be passed as baseline,
+# which reports the overhead of the binding against the same operations in C++:
+#   python3 python_benchmark.py --cpp-baseline cpp_results.json --json python_results.json
+#
+# LoadFile and WriteFile release the GIL, so loads and writes in several threads run on separate cores.
+# LoadBytes parses content in memory without writing a temporary file.
+# to_dict exports the whole buffer in one call instead of one call per key.
+# get and set dispatch on the type once instead of trying an overload per type.
+# get_many resolves many keys in one call.
+# export_array and set_array move numeric sections to and from arrays without a python object per value.
+import argparse
+import array
+import datetime
+import json
+import os
+import platform
+import statistics
+import tempfile
+import threading
+import time
+from IniBuffer import *
+
+DATA_DIRECTORY = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "data")
+PERFORMANCE_FILE = os.path.join(DATA_DIRECTORY, "performance.ini")
+
+SECTION_COUNT = 2000
+KEYS_PER_SECTION = 100
+
+# Python benchmarks (group, name) measuring the same operation as a C++ benchmark (group, name) of IniBufferBenchmarkApp.
+CPP_BASELINES = {
+    ("Single value access", "GetValue_int"): ("Key lookup with literal names", "GetValue<int>(std::string, std::string)"),
+    ("Single value access", "get int"): ("Key lookup with literal names", "GetValue<int>(std::string, std::string)"),
+    ("Single value access", "section[key]"): ("Key lookup with literal names", "GetValue<int>(std::string, std::string)"),
+    ("Load data/performance.ini", "LoadFile"): ("Parse", "LoadFile"),
+    ("Load data/performance.ini", "LoadBytes"): ("Parse", "LoadFromBuffer"),
+}
+
+class Suite:
+    """Runs benchmarks in calibrated rounds and collects their statistics."""
+
+    def __init__(self, rounds, min_time, name_filter, cpp_baseline):
+        self.rounds = rounds
+        self.min_time = min_time
+        self.name_filter = name_filter
+        self.cpp_baseline = cpp_baseline
+        self.results = []
+        self.group = ""
+
+    def begin_group(self, group, details=""):
+        self.group = group
+        print(group + (" " + details if details else ""))
+
+    def end_group(self):
+        print("")
+
+    def selected(self, name):
+        return self.name_filter is None or self.name_filter in self.group + "/" + name
+
+    def calibrate(self, function):
+        """Returns the number of calls per round so that a round takes at least min_time."""
+        iterations = 1
+        while True:
+            start = time.perf_counter()
+            for i in range(iterations):
+                function()
+            if time.perf_counter() - start >= self.min_time:
+                return iterations
+            iterations *= 2
+
+    def bench(self, name, function, items=None, item_name="key", size=None):
+        """Measures a function. items: values processed per call, size: bytes processed per call."""
+        if not self.selected(name):
+            return
+        iterations = self.calibrate(function)
+        times = []
+        for round in range(self.rounds):
+            start = time.perf_counter()
+            for i in range(iterations):
+                function()
+            times.append((time.perf_counter() - start)/iterations)
+
+        median = statistics.median(times)
+        extra = {}
+        if median < 1e-5:
+            line = "  {}: {:.0f} ns/op".format(name, median*1e9)
+        else:
+            line = "  {}: {:.1f} us/op".format(name, median*1e6)
+        if items is not None:
+            extra["ns_per_" + item_name] = median*1e9/items
+            line += ", {:.0f} ns/{}".format(extra["ns_per_" + item_name], item_name)
+        if size is not None:
+            extra["mb_per_s"] = size/median/(1024*1024)
+            line += ", {:.0f} MB/s".format(extra["mb_per_s"])
+
+        baseline = self.find_baseline(name)
+        if baseline is not None:
+            extra["cpp_baseline_ns"] = baseline["ns_per_op"]
+            extra["binding_overhead_ns"] = median*1e9 - baseline["ns_per_op"]
+            line += " (C++ {:.0f} ns, {:+.0f} ns)".format(extra["cpp_baseline_ns"], extra["binding_overhead_ns"])
+        print(line)
+
+        self.add_result(name, times, iterations, extra)
+
+    def add_result(self, name, times, iterations, extra):
+        """Records the seconds per call of each round."""
+        self.results.append({
+            "group": self.group,
+            "name": name,
+            "stats": {
+                "min": min(times),
+                "max": max(times),
+                "mean": statistics.mean(times),
+                "median": statistics.median(times),
+                "stddev": statistics.stdev(times) if len(times) > 1 else 0.0,
+                "rounds": len(times),
+                "iterations": iterations},
+            "extra": extra})
+
+    def find_baseline(self, name):
+        if self.cpp_baseline is None or (self.group, name) not in CPP_BASELINES:
+            return None
+        cpp_group, cpp_name = CPP_BASELINES[(self.group, name)]
+        for benchmark in self.cpp_baseline["benchmarks"]:
+            if benchmark["group"] == cpp_group and benchmark["name"] == cpp_name:
+                return benchmark
+        return None
+
+    def write_json(self, fullfilename):
+        document = {
+            "machine_info": {
+                "python_version": platform.python_version(),
+                "python_implementation": platform.python_implementation(),
+                "platform": platform.platform(),
+                "cpu_count": os.cpu_count()},
+            "datetime": datetime.datetime.now().isoformat(),
+            "benchmarks": self.results,
+            "cpp_baseline": self.cpp_baseline}
+        with open(fullfilename, "w") as file:
+            json.dump(document, file, indent=2)
+        print("Results written to " + fullfilename)
+
+def create_file(fullfilename):
+    with open(fullfilename, "w") as file:
+        for section in range(SECTION_COUNT):
+            file.write("[section" + str(section) + "]\n")
+            for key in range(KEYS_PER_SECTION):
+                file.write("key" + str(key) + " = value of key " + str(key) + "\n")
+
+def measure(thread_count, function):
+    threads = [threading.Thread(target=function, args=(i,)) for i in range(thread_count)]
+    start = time.perf_counter()
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    return time.perf_counter() - start
+
+def benchmark_threads(suite):
+    directory = tempfile.mkdtemp()
+    fullfilename = os.path.join(directory, "python_benchmark.ini")
+    create_file(fullfilename)
+    size = os.path.getsize(fullfilename)
+
+    def load(i):
+        ini = IniBuffer()
+        ini.LoadFile(fullfilename)
+
+    loaded = IniBuffer()
+    loaded.LoadFile(fullfilename)
+
+    def write(i):
+        loaded.WriteFile(os.path.join(directory, "output" + str(i) + ".ini"), False)
+
+    suite.begin_group("Concurrent loads and writes", "of " + str(size//(1024*1024)) + " MB (" + str(os.cpu_count()) + " cores)")
+    for name, function in (("LoadFile", load), ("WriteFile", write)):
+        single = measure(1, function)
+        for thread_count in (1, 2, 4, 8):
+            result_name = name + " " + str(thread_count) + " threads"
+            if not suite.selected(result_name):
+                continue
+            times = [measure(thread_count, function) for round in range(suite.rounds)]
+            elapsed = statistics.median(times)
+            extra = {"threads": thread_count, "mb_per_s": thread_count*size/elapsed/(1024*1024), "speedup": thread_count*single/elapsed}
+            print("  {}: {:.3f} s, {:.0f} MB/s, speedup {:.2f}".format(result_name, elapsed, extra["mb_per_s"], extra["speedup"]))
+            suite.add_result(result_name, times, 1, extra)
+
+    # Python code keeps running while another thread loads.
+    loader = threading.Thread(target=load, args=(0,))
+    counter = 0
+    loader.start()
+    while loader.is_alive():
+        counter += 1
+    print("  Main thread loop iterations during one LoadFile: " + str(counter))
+
+    for file in os.listdir(directory):
+        os.remove(os.path.join(directory, file))
+    os.rmdir(directory)
+    suite.end_group()
+
+def benchmark_load(suite):
+    with open(PERFORMANCE_FILE, "rb") as file:
+        content = file.read()
+
+    def through_temp_file():
+        with tempfile.NamedTemporaryFile(suffix=".ini", delete=False) as file:
+            file.write(content)
+        try:
+            IniBuffer().LoadFile(file.name)
+        finally:
+            os.remove(file.name)
+
+    suite.begin_group("Load data/performance.ini", "(" + str(len(content)//1024) + " kB)")
+    suite.bench("LoadFile", lambda: IniBuffer().LoadFile(PERFORMANCE_FILE), size=len(content))
+    suite.bench("temp file + LoadFile", through_temp_file, size=len(content))
+    suite.bench("LoadBytes", lambda: IniBuffer().LoadBytes(content), size=len(content))
+    suite.bench("LoadBytes memoryview", lambda: IniBuffer().LoadBytes(memoryview(content)), size=len(content))
+    suite.end_group()
+
+def benchmark_write(suite):
+    ini = IniBuffer()
+    ini.LoadFile(PERFORMANCE_FILE)
+    directory = tempfile.mkdtemp()
+    fullfilename = os.path.join(directory, "output.ini")
+    ini.WriteFile(fullfilename, False)
+    size = os.path.getsize(fullfilename)
+
+    suite.begin_group("Write data/performance.ini", "(" + str(size//1024) + " kB)")
+    suite.bench("WriteFile", lambda: ini.WriteFile(fullfilename, False), size=size)
+    suite.end_group()
+
+    os.remove(fullfilename)
+    os.rmdir(directory)
+
+def benchmark_dict_export(suite):
+    ini = IniBuffer()
+    ini.LoadFile(PERFORMANCE_FILE)
+    content = ini.to_dict()
+    getters = {int: ini.GetValue_int, float: ini.GetValue_float, bool: ini.GetValue_bool, str: ini.GetValue_string}
+
+    def per_key():
+        result = {}
+        for section_name, properties in content.items():
+            section = result[section_name] = {}
+            for key_name, value in properties.items():
+                try:
+                    section[key_name] = None if value is None else getters[type(value)](section_name, key_name)
+                except RuntimeError: # e.g. an int out of the C++ int range
+                    section[key_name] = value
+        return result
+
+    def per_section():
+        return {section_name: ini.section_dict(section_name) for section_name in content}
+
+    key_count = sum(len(properties) for properties in content.values())
+    suite.begin_group("Export data/performance.ini to dicts", "(" + str(key_count) + " keys)")
+    suite.bench("per key GetValue_*", per_key, items=key_count)
+    suite.bench("section_dict", per_section, items=key_count)
+    suite.bench("to_dict", ini.to_dict, items=key_count)
+    suite.end_group()
+
+def benchmark_single_access(suite):
+    ini = IniBuffer()
+    ini.AddValue("values", "int", 7)
+    ini.AddValue("values", "float", 1.5)
+    ini.AddValue("values", "bool", True)
+    ini.AddValue("values", "string", "red")
+    section = ini["values"]
+
+    suite.begin_group("Single value access")
+    suite.bench("GetValue_int", lambda: ini.GetValue_int("values", "int"))
+    suite.bench("get int", lambda: ini.get("values", "int"))
+    suite.bench("section[key]", lambda: section["int"])
+    suite.bench("ini[section][key]", lambda: ini["values"]["int"])
+    suite.bench("key in section", lambda: "missing" in section)
+    suite.bench("GetValue_float", lambda: ini.GetValue_float("values", "float"))
+    suite.bench("get float", lambda: ini.get("values", "float"))
+    suite.bench("GetValue_string", lambda: ini.GetValue_string("values", "string"))
+    suite.bench("get string", lambda: ini.get("values", "string"))
+    suite.bench("AddValue int", lambda: ini.AddValue("values", "int", 7))
+    suite.bench("set int", lambda: ini.set("values", "int", 7))
+    suite.bench("AddValue float", lambda: ini.AddValue("values", "float", 1.5))
+    suite.bench("set float", lambda: ini.set("values", "float", 1.5))
+    suite.bench("AddValue string", lambda: ini.AddValue("values", "string", "red"))
+    suite.bench("set string", lambda: ini.set("values", "string", "red"))
+    suite.bench("python call (baseline)", lambda: None)
+    suite.end_group()
+
+def benchmark_batched_lookups(suite):
+    key_count = 200
+    ini = IniBuffer()
+    for key in range(key_count):
+        ini.AddValue("features", "key" + str(key), key)
+    key_names = ["key" + str(key) for key in range(key_count)]
+    names = [("features", key_name) for key_name in key_names]
+
+    suite.begin_group("Batched lookups", "(" + str(key_count) + " keys per call)")
+    suite.bench("GetValue_int per key", lambda: [ini.GetValue_int("features", key_name) for key_name in key_names], items=key_count)
+    suite.bench("get per key", lambda: [ini.get("features", key_name) for key_name in key_names], items=key_count)
+    suite.bench("get_many(section, keys)", lambda: ini.get_many("features", key_names), items=key_count)
+    suite.bench("get_many([(section, key)])", lambda: ini.get_many(names), items=key_count)
+    suite.end_group()
+
+def benchmark_arrays(suite):
+    key_count = 1000
+    ini = IniBuffer()
+    key_names = ["coefficient" + str(key) for key in range(key_count)]
+    values = array.array("d", (key*0.001 for key in range(key_count)))
+    ini.set_array("calibration", key_names, values)
+    out = array.array("d", bytes(8*key_count))
+
+    suite.begin_group("Numeric arrays", "(" + str(key_count) + " float values per call)")
+    suite.bench("section_dict to array", lambda: array.array("d", ini.section_dict("calibration").values()), items=key_count, item_name="value")
+    suite.bench("export_array", lambda: ini.export_array("calibration", out), items=key_count, item_name="value")
+    suite.bench("set per key", lambda: [ini.set("calibration", key_name, value) for key_name, value in zip(key_names, values)], items=key_count, item_name="value")
+    suite.bench("set_array", lambda: ini.set_array("calibration", key_names, values), items=key_count, item_name="value")
+    suite.end_group()
+
+def main():
+    parser = argparse.ArgumentParser(description="Benchmarks of the IniBuffer python binding.")
+    parser.add_argument("--json", help="Writes the results to this JSON file.")
+    parser.add_argument("--cpp-baseline", help="JSON results of IniBufferBenchmarkApp --json, compared with the same operations in python.")
+    parser.add_argument("--filter", help="Runs only benchmarks whose group/name contains this text.")
+    parser.add_argument("--rounds", type=int, default=5, help="Number of measured rounds per benchmark.")
+    parser.add_argument("--min-time", type=float, default=0.05, help="Minimum duration of a round in seconds.")
+    parser.add_argument("--skip-threads", action="store_true", help="Skips the threading benchmark, which writes a large temporary file.")
+    arguments = parser.parse_args()
+
+    cpp_baseline = None
+    if arguments.cpp_baseline is not None:
+        with open(arguments.cpp_baseline) as file:
+            cpp_baseline = json.load(file)
+
+    suite = Suite(arguments.rounds, arguments.min_time, arguments.filter, cpp_baseline)
+    if not arguments.skip_threads:
+        benchmark_threads(suite)
+    benchmark_load(suite)
+    benchmark_write(suite)
+    benchmark_dict_export(suite)
+    benchmark_single_access(suite)
+    benchmark_batched_lookups(suite)
+    benchmark_arrays(suite)
+
+    if arguments.json is not None:
+        suite.write_json(arguments.json)
+
+if __name__ == "__main__":
+	main()
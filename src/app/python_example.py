@@ -1,9 +1,10 @@
 #!/usr/bin/env python3
+import os
 from IniBuffer import *
 
 def main():
     ini = IniBuffer()
-    ini.LoadFile("/home/pascal/Desktop/test.ini")
+    ini.LoadFile(os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "data", "test.ini"))
 #------------------------------------------------------------------
 # Request an int
 
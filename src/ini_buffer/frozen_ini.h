@@ -0,0 +1,942 @@
+/**
+ * @file frozen_ini.h
+ * @author Pascal Enderli
+ * @date 2026.10.18
+ * @brief Immutable compact representation of an IniBuffer with perfect hash lookups.
+ */
+
+#ifndef FROZEN_INI_H_
+#define FROZEN_INI_H_
+
+#include<algorithm>
+#include<cstdint>
+#include<cstring>
+#include<limits>
+#include<memory>
+#include<string>
+#include<vector>
+#include"ini_buffer.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define FROZEN_INI_POSIX
+#include<cerrno>
+#include<fcntl.h>
+#include<sys/mman.h>
+#include<unistd.h>
+#endif
+
+//===================================================================================
+// FrozenIni class declaration
+
+/** Immutable compact copy of an IniBuffer. Created by IniBuffer::Freeze().
+*   @n All sections, keys, values and pre-converted typed values are packed into one contiguous image.
+*   @n The image only contains offsets and no pointers, so it is position independent.
+*   @n Therefore processes can share one copy of it, see Publish() and Map().
+*   @n Lookups use a minimal perfect hash: one hash of the names, two table reads and one comparison.
+*   @n Copies share the same image. Since it is never modified, it can be read from any number of threads.
+*   @n Errors are reported using IniExceptions, the same way as by the IniBuffer.
+*/
+class FrozenIni
+{
+    template<typename, typename> friend class BasicIniBuffer;
+
+    public:
+
+    /// Constructs an empty frozen buffer.
+    FrozenIni();
+
+    //===================================================================================
+    // Begin of public FrozenIni Interface
+
+    /** Receive a requested value.
+    *
+    *   @details
+    *   Behaves like IniBuffer::GetValue. Ints, floats and bools are converted once while freezing.
+    *
+    *   @param_t ValueT The type of the requested data member. Supported are {int, float, std::string, bool}
+    */
+    template<typename ValueT>
+    ValueT GetValue(const std::string& section_name, const std::string& key_name) const;
+
+    /// Same as GetValue but does not construct temporary std::strings from the names.
+    template<typename ValueT>
+    ValueT GetValue(const char* section_name, const char* key_name) const;
+
+    /** Receive a view on a stored string value without copying it.
+    *
+    *   @details
+    *   If the value is not present or is not a string, an IniException is thrown.
+    *   @n The view stays valid as long as any FrozenIni sharing the same image exists. The viewed string is null terminated.
+    */
+    StringView GetStringView(const std::string& section_name, const std::string& key_name) const;
+
+    /// Checks if the requested key is present.
+    bool HasValue(const std::string& section_name, const std::string& key_name) const noexcept;
+
+    /// Returns the number of properties.
+    size_t GetPropertyCount() const noexcept;
+
+    /// Returns the number of sections.
+    size_t GetSectionCount() const noexcept;
+
+    /// Returns the memory in bytes occupied by the image.
+    size_t GetMemoryUsage() const noexcept;
+
+    /** Publishes the image as the next version of a shared file.
+    *
+    *   @details
+    *   The image is written to a temporary file next to the target, which then atomically replaces the target.
+    *   @n Processes which mapped a previous version keep it until they map again.
+    *   @n A path on a tmpfs (e.g. /dev/shm/<name>) keeps the image in shared memory only. Any other path is a file backed mapping.
+    *   @n Versions are counted per file starting at 1. Only one process must publish to the same file.
+    *   @n Only supported on POSIX systems, otherwise an IniException is thrown.
+    *
+    *   @param fullfilename Path of the shared file.
+    *
+    *   @return The published version.
+    */
+    uint64_t Publish(const std::string& fullfilename) const;
+
+    /** Maps the latest published version of a shared file read only.
+    *
+    *   @details
+    *   All processes mapping the same version share one copy of the image in memory.
+    *   @n If the file is not a valid image, an IniException is thrown.
+    *   @n Only supported on POSIX systems, otherwise an IniException is thrown.
+    */
+    static FrozenIni Map(const std::string& fullfilename);
+
+    /** Returns the latest published version of a shared file without mapping it.
+    *
+    *   @details
+    *   A worker compares it with GetVersion() of its mapping to detect updates. Returns 0 if nothing is published yet.
+    */
+    static uint64_t GetPublishedVersion(const std::string& fullfilename);
+
+    /// Returns the published version of the image. 0 if the image was not mapped from a shared file.
+    uint64_t GetVersion() const noexcept;
+
+    // End of public FrozenIni interface
+    //===================================================================================
+
+    private:
+
+    /// Identifies an image.
+    static constexpr uint32_t image_magic = 0x46494E49; // "INIF"
+
+    /// Version of the image layout.
+    static constexpr uint32_t image_version = 1;
+
+    /// Slot without an entry.
+    static constexpr uint32_t empty_slot = 0xFFFFFFFF;
+
+    /// Alignment of the hot regions of the image.
+    static constexpr uint64_t cache_line_size = 64;
+
+    /// String values longer than this are stored apart from the names and short values.
+    static constexpr size_t long_string_size = 64;
+
+    /// Beginning of the image. All offsets are relative to the beginning of the image.
+    struct Header
+    {
+        uint32_t magic;
+        uint32_t layout_version;
+        uint64_t image_size;
+        uint32_t section_count;
+        uint32_t entry_count;
+        uint32_t bucket_count;
+        uint32_t slot_count;
+        uint64_t seed;
+        uint64_t published_version;
+        uint64_t sections_offset;
+        uint64_t entries_offset;
+        uint64_t displacements_offset;
+        uint64_t slots_offset;
+        uint64_t strings_offset;
+    };
+
+    /// A section name in the string region.
+    struct SectionEntry
+    {
+        uint32_t name_offset;
+        uint32_t name_size;
+    };
+
+    /// A property with its names, the value string and the pre-converted typed value.
+    struct Entry
+    {
+        uint64_t hash;
+        uint32_t section_offset;
+        uint32_t section_size;
+        uint32_t key_offset;
+        uint32_t key_size;
+        uint32_t value_offset;
+        uint32_t value_size;
+        int32_t int_value;
+        float float_value;
+        uint32_t section_index;
+        uint8_t type;
+        uint8_t is_converted;
+        uint8_t bool_value;
+        uint8_t reserved;
+    };
+
+    /// Data type alias of a value of the IniBuffer. Used to convert values the same way as the IniBuffer.
+    using Value_t = IniBuffer::Section::StringifiedValue;
+
+    /// Constructs a frozen buffer on an image kept alive by storage.
+    FrozenIni(std::shared_ptr<const void> storage, const char* image) noexcept;
+
+    /** Packs the content of a buffer into a new image.
+    *
+    *   @details
+    *   Without a profile, entries and strings are stored in map order. With a profile, read keys are stored first.
+    *   @n Accepts buffers of any storage.
+    */
+    template<typename BufferT>
+    static FrozenIni Build(const BufferT& buffer, const IniBufferBase::AccessReport* profile);
+
+    /** Finds displacements which map every hash to its own slot.
+    *
+    *   @details
+    *   Returns false if no displacement was found for a bucket. Then another seed or more slots are required.
+    */
+    static bool BuildPerfectHash(const std::vector<uint64_t>& hashes, uint32_t bucket_count, uint32_t slot_count,
+                                 std::vector<uint32_t>& displacements, std::vector<uint32_t>& slots);
+
+    /// Hashes a section and a key name together.
+    static uint64_t Hash(const char* section_name, size_t section_name_size, const char* key_name, size_t key_name_size, uint64_t seed) noexcept;
+
+    /// Combines a hash with a string, eight bytes at a time.
+    static uint64_t HashBytes(uint64_t hash, const char* data, size_t size) noexcept;
+
+    /// Mixes the bits of a hash.
+    static uint64_t Mix(uint64_t hash) noexcept;
+
+    /// Maps a 32 bit hash uniformly to the range [0, range).
+    static uint32_t Reduce(uint32_t hash, uint32_t range) noexcept;
+
+    /// Returns the bucket of a hash.
+    static uint32_t GetBucket(uint64_t hash, uint32_t bucket_count) noexcept;
+
+    /// Returns the slot of a hash for a given displacement of its bucket.
+    static uint32_t GetSlot(uint64_t hash, uint32_t displacement, uint32_t slot_count) noexcept;
+
+    /// Looks up an entry. Returns nullptr if the key is not present.
+    const Entry* Find(const char* section_name, size_t section_name_size, const char* key_name, size_t key_name_size) const noexcept;
+
+    /// Looks up an entry. Throws an IniException if the key is not present.
+    const Entry& At(const char* section_name, size_t section_name_size, const char* key_name, size_t key_name_size) const;
+
+    /// Converts the value of an entry to the requested type.
+    template<typename ValueT>
+    ValueT CastValue(const Entry& entry) const;
+
+    /// Checks that an image read from a file is complete and all offsets are inside of it.
+    static void ValidateImage(const char* image, size_t size, const std::string& fullfilename);
+
+    /// Returns the header of the image.
+    const Header& GetHeader() const noexcept;
+
+    /// Returns a string of the string region.
+    StringView GetString(uint32_t offset, uint32_t size) const noexcept;
+
+    /// Keeps the memory of the image alive.
+    std::shared_ptr<const void> storage_;
+
+    /// Beginning of the image.
+    const char* image_;
+};
+
+//===================================================================================
+// Implementation
+
+constexpr uint32_t FrozenIni::image_magic;
+constexpr uint32_t FrozenIni::image_version;
+constexpr uint32_t FrozenIni::empty_slot;
+constexpr uint64_t FrozenIni::cache_line_size;
+constexpr size_t FrozenIni::long_string_size;
+
+template<typename StoragePolicyT, typename AllocatorT>
+FrozenIni BasicIniBuffer<StoragePolicyT, AllocatorT>::Freeze() const
+{
+    try
+    {
+        return FrozenIni::Build(*this, nullptr);
+    }
+    catch(IniException& e){throw;}
+    catch(std::exception& e){throw INI_EXCEPTION(e.what());}
+    catch(...){throw;}
+}
+
+template<typename StoragePolicyT, typename AllocatorT>
+FrozenIni BasicIniBuffer<StoragePolicyT, AllocatorT>::Freeze(const AccessReport& profile) const
+{
+    try
+    {
+        return FrozenIni::Build(*this, &profile);
+    }
+    catch(IniException& e){throw;}
+    catch(std::exception& e){throw INI_EXCEPTION(e.what());}
+    catch(...){throw;}
+}
+
+FrozenIni::FrozenIni()
+: FrozenIni(Build(IniBuffer(), nullptr))
+{}
+
+FrozenIni::FrozenIni(std::shared_ptr<const void> storage, const char* image) noexcept
+: storage_(std::move(storage))
+, image_(image)
+{}
+
+template<typename ValueT>
+ValueT FrozenIni::GetValue(const std::string& section_name, const std::string& key_name) const
+{
+    return CastValue<ValueT>(At(section_name.data(), section_name.size(), key_name.data(), key_name.size()));
+}
+
+template<typename ValueT>
+ValueT FrozenIni::GetValue(const char* section_name, const char* key_name) const
+{
+    if(section_name == nullptr || key_name == nullptr)
+    {
+        throw INI_EXCEPTION("Requested section or key name is a nullptr.");
+    }
+    return CastValue<ValueT>(At(section_name, std::strlen(section_name), key_name, std::strlen(key_name)));
+}
+
+StringView FrozenIni::GetStringView(const std::string& section_name, const std::string& key_name) const
+{
+    const Entry& entry = At(section_name.data(), section_name.size(), key_name.data(), key_name.size());
+    if(entry.type != IniBuffer::DataType::STRING)
+    {
+        throw INI_EXCEPTION("Stored value is not a std::string.");
+    }
+    return GetString(entry.value_offset, entry.value_size);
+}
+
+bool FrozenIni::HasValue(const std::string& section_name, const std::string& key_name) const noexcept
+{
+    return Find(section_name.data(), section_name.size(), key_name.data(), key_name.size()) != nullptr;
+}
+
+size_t FrozenIni::GetPropertyCount() const noexcept
+{
+    return GetHeader().entry_count;
+}
+
+size_t FrozenIni::GetSectionCount() const noexcept
+{
+    return GetHeader().section_count;
+}
+
+size_t FrozenIni::GetMemoryUsage() const noexcept
+{
+    return GetHeader().image_size;
+}
+
+template<>
+int FrozenIni::CastValue<int>(const Entry& entry) const
+{
+    if(entry.type == IniBuffer::DataType::INT && entry.is_converted)
+    {
+        return entry.int_value;
+    }
+    // Not convertible: reports the same error as the IniBuffer.
+    return Value_t(GetString(entry.value_offset, entry.value_size).ToString()).GetValue<int>();
+}
+
+template<>
+float FrozenIni::CastValue<float>(const Entry& entry) const
+{
+    if(entry.type == IniBuffer::DataType::FLOAT && entry.is_converted)
+    {
+        return entry.float_value;
+    }
+    return Value_t(GetString(entry.value_offset, entry.value_size).ToString()).GetValue<float>();
+}
+
+template<>
+bool FrozenIni::CastValue<bool>(const Entry& entry) const
+{
+    if(entry.type == IniBuffer::DataType::BOOL && entry.is_converted)
+    {
+        return entry.bool_value != 0;
+    }
+    return Value_t(GetString(entry.value_offset, entry.value_size).ToString()).GetValue<bool>();
+}
+
+template<>
+std::string FrozenIni::CastValue<std::string>(const Entry& entry) const
+{
+    if(entry.type == IniBuffer::DataType::STRING)
+    {
+        return GetString(entry.value_offset, entry.value_size).ToString();
+    }
+    throw INI_EXCEPTION("Stored value is not a std::string.");
+}
+
+template<typename ValueT>
+ValueT FrozenIni::CastValue(const Entry& entry) const
+{
+    return Value_t(GetString(entry.value_offset, entry.value_size).ToString()).GetValue<ValueT>();
+}
+
+#ifdef FROZEN_INI_POSIX
+uint64_t FrozenIni::Publish(const std::string& fullfilename) const
+{
+    Header header = GetHeader();
+    header.published_version = GetPublishedVersion(fullfilename) + 1;
+
+    // Readers either see the complete previous or the complete new file, never a partial one.
+    const std::string temp_filename = fullfilename + ".tmp" + std::to_string(getpid());
+    int fd = open(temp_filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if(fd < 0)
+    {
+        throw INI_EXCEPTION("Opening file failed: " + temp_filename + " (" + std::strerror(errno) + ")");
+    }
+
+    const char* parts[] = {reinterpret_cast<const char*>(&header), image_ + sizeof(Header)};
+    const size_t sizes[] = {sizeof(Header), header.image_size - sizeof(Header)};
+    for(size_t i = 0; i < 2; ++i)
+    {
+        const char* data = parts[i];
+        size_t size = sizes[i];
+        while(size > 0)
+        {
+            ssize_t written = write(fd, data, size);
+            if(written < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if(written <= 0)
+            {
+                const std::string error = std::strerror(errno);
+                close(fd);
+                unlink(temp_filename.c_str());
+                throw INI_EXCEPTION("Writing file failed: " + temp_filename + " (" + error + ")");
+            }
+            data += written;
+            size -= static_cast<size_t>(written);
+        }
+    }
+
+    if(close(fd) != 0 || rename(temp_filename.c_str(), fullfilename.c_str()) != 0)
+    {
+        const std::string error = std::strerror(errno);
+        unlink(temp_filename.c_str());
+        throw INI_EXCEPTION("Publishing file failed: " + fullfilename + " (" + error + ")");
+    }
+    LOG("Published " + fullfilename + " version " + std::to_string(header.published_version));
+    return header.published_version;
+}
+
+FrozenIni FrozenIni::Map(const std::string& fullfilename)
+{
+    int fd = open(fullfilename.c_str(), O_RDONLY);
+    if(fd < 0)
+    {
+        throw INI_EXCEPTION("Opening file failed: " + fullfilename + " (" + std::strerror(errno) + ")");
+    }
+
+    struct stat file_status;
+    if(fstat(fd, &file_status) != 0 || file_status.st_size < static_cast<off_t>(sizeof(Header)))
+    {
+        close(fd);
+        throw INI_EXCEPTION("File is not a frozen ini image: " + fullfilename);
+    }
+
+    const size_t size = static_cast<size_t>(file_status.st_size);
+    void* memory = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if(memory == MAP_FAILED)
+    {
+        throw INI_EXCEPTION("Mapping file failed: " + fullfilename + " (" + std::strerror(errno) + ")");
+    }
+
+    std::shared_ptr<const void> storage(memory, [size](const void* address)
+    {
+        munmap(const_cast<void*>(address), size);
+    });
+
+    ValidateImage(static_cast<const char*>(memory), size, fullfilename);
+    return FrozenIni(storage, static_cast<const char*>(memory));
+}
+
+uint64_t FrozenIni::GetPublishedVersion(const std::string& fullfilename)
+{
+    int fd = open(fullfilename.c_str(), O_RDONLY);
+    if(fd < 0)
+    {
+        if(errno == ENOENT)
+        {
+            return 0;
+        }
+        throw INI_EXCEPTION("Opening file failed: " + fullfilename + " (" + std::strerror(errno) + ")");
+    }
+
+    Header header;
+    ssize_t read_size = pread(fd, &header, sizeof(header), 0);
+    close(fd);
+    if(read_size != static_cast<ssize_t>(sizeof(header)) || header.magic != image_magic || header.layout_version != image_version)
+    {
+        throw INI_EXCEPTION("File is not a frozen ini image: " + fullfilename);
+    }
+    return header.published_version;
+}
+#else
+uint64_t FrozenIni::Publish(const std::string& fullfilename) const
+{
+    throw INI_EXCEPTION("Publishing is only supported on POSIX systems: " + fullfilename);
+}
+
+FrozenIni FrozenIni::Map(const std::string& fullfilename)
+{
+    throw INI_EXCEPTION("Mapping is only supported on POSIX systems: " + fullfilename);
+}
+
+uint64_t FrozenIni::GetPublishedVersion(const std::string& fullfilename)
+{
+    throw INI_EXCEPTION("Publishing is only supported on POSIX systems: " + fullfilename);
+}
+#endif
+
+uint64_t FrozenIni::GetVersion() const noexcept
+{
+    return GetHeader().published_version;
+}
+
+void FrozenIni::ValidateImage(const char* image, size_t size, const std::string& fullfilename)
+{
+    Header header;
+    if(size < sizeof(header))
+    {
+        throw INI_EXCEPTION("Image is truncated: " + fullfilename);
+    }
+    std::memcpy(&header, image, sizeof(header));
+
+    if(header.magic != image_magic || header.layout_version != image_version)
+    {
+        throw INI_EXCEPTION("Unknown image format: " + fullfilename);
+    }
+
+    auto is_inside = [size](uint64_t offset, uint64_t count, uint64_t element_size)
+    {
+        return offset % 8 == 0 && offset <= size && count <= (size - offset)/element_size;
+    };
+
+    if(header.image_size != size ||
+       header.slot_count == 0 ||
+       header.bucket_count == 0 ||
+       !is_inside(header.sections_offset, header.section_count, sizeof(SectionEntry)) ||
+       !is_inside(header.entries_offset, header.entry_count, sizeof(Entry)) ||
+       !is_inside(header.displacements_offset, header.bucket_count, sizeof(uint32_t)) ||
+       !is_inside(header.slots_offset, header.slot_count, sizeof(uint32_t)) ||
+       !is_inside(header.strings_offset, 0, 1))
+    {
+        throw INI_EXCEPTION("Image tables are out of bounds: " + fullfilename);
+    }
+
+    // Every string is followed by its null terminator.
+    const uint64_t strings_size = size - header.strings_offset;
+    auto is_string = [strings_size](uint32_t offset, uint32_t string_size)
+    {
+        return static_cast<uint64_t>(offset) + string_size < strings_size;
+    };
+
+    const Entry* entries = reinterpret_cast<const Entry*>(image + header.entries_offset);
+    for(uint32_t i = 0; i < header.entry_count; ++i)
+    {
+        if(!is_string(entries[i].section_offset, entries[i].section_size) ||
+           !is_string(entries[i].key_offset, entries[i].key_size) ||
+           !is_string(entries[i].value_offset, entries[i].value_size))
+        {
+            throw INI_EXCEPTION("Image strings are out of bounds: " + fullfilename);
+        }
+    }
+
+    const uint32_t* slots = reinterpret_cast<const uint32_t*>(image + header.slots_offset);
+    for(uint32_t i = 0; i < header.slot_count; ++i)
+    {
+        if(slots[i] != empty_slot && slots[i] >= header.entry_count)
+        {
+            throw INI_EXCEPTION("Image slots are out of bounds: " + fullfilename);
+        }
+    }
+}
+
+const FrozenIni::Entry* FrozenIni::Find(const char* section_name, size_t section_name_size, const char* key_name, size_t key_name_size) const noexcept
+{
+    const Header& header = GetHeader();
+    if(header.entry_count == 0)
+    {
+        return nullptr;
+    }
+
+    const uint64_t hash = Hash(section_name, section_name_size, key_name, key_name_size, header.seed);
+    const uint32_t* displacements = reinterpret_cast<const uint32_t*>(image_ + header.displacements_offset);
+    const uint32_t* slots = reinterpret_cast<const uint32_t*>(image_ + header.slots_offset);
+
+    const uint32_t entry_index = slots[GetSlot(hash, displacements[GetBucket(hash, header.bucket_count)], header.slot_count)];
+    if(entry_index == empty_slot)
+    {
+        return nullptr;
+    }
+
+    const Entry& entry = reinterpret_cast<const Entry*>(image_ + header.entries_offset)[entry_index];
+    if(entry.hash != hash ||
+       entry.section_size != section_name_size ||
+       entry.key_size != key_name_size ||
+       std::memcmp(image_ + header.strings_offset + entry.key_offset, key_name, key_name_size) != 0 ||
+       std::memcmp(image_ + header.strings_offset + entry.section_offset, section_name, section_name_size) != 0)
+    {
+        return nullptr;
+    }
+    return &entry;
+}
+
+const FrozenIni::Entry& FrozenIni::At(const char* section_name, size_t section_name_size, const char* key_name, size_t key_name_size) const
+{
+    const Entry* entry = Find(section_name, section_name_size, key_name, key_name_size);
+    if(entry == nullptr)
+    {
+        throw INI_EXCEPTION("Requested key is not present in the data structure. Section: " + std::string(section_name, section_name_size) + "; Key: " + std::string(key_name, key_name_size));
+    }
+    return *entry;
+}
+
+const FrozenIni::Header& FrozenIni::GetHeader() const noexcept
+{
+    return *reinterpret_cast<const Header*>(image_);
+}
+
+StringView FrozenIni::GetString(uint32_t offset, uint32_t size) const noexcept
+{
+    return StringView(image_ + GetHeader().strings_offset + offset, size);
+}
+
+uint64_t FrozenIni::Hash(const char* section_name, size_t section_name_size, const char* key_name, size_t key_name_size, uint64_t seed) noexcept
+{
+    // The sizes are part of the hash, so ("ab", "c") and ("a", "bc") differ.
+    uint64_t hash = HashBytes(seed ^ section_name_size, section_name, section_name_size);
+    hash = HashBytes(hash ^ (static_cast<uint64_t>(key_name_size) << 32), key_name, key_name_size);
+    return Mix(hash);
+}
+
+uint64_t FrozenIni::HashBytes(uint64_t hash, const char* data, size_t size) noexcept
+{
+    const uint64_t multiplier = 0x9E3779B97F4A7C15ULL;
+    uint64_t word;
+    for(; size >= sizeof(word); data += sizeof(word), size -= sizeof(word))
+    {
+        std::memcpy(&word, data, sizeof(word));
+        hash = (hash ^ word)*multiplier;
+        hash ^= hash >> 29;
+    }
+    if(size > 0)
+    {
+        word = 0;
+        for(size_t i = 0; i < size; ++i)
+        {
+            word |= static_cast<uint64_t>(static_cast<unsigned char>(data[i])) << (8*i);
+        }
+        hash = (hash ^ word)*multiplier;
+        hash ^= hash >> 29;
+    }
+    return hash;
+}
+
+uint64_t FrozenIni::Mix(uint64_t hash) noexcept
+{
+    hash ^= hash >> 30;
+    hash *= 0xBF58476D1CE4E5B9ULL;
+    hash ^= hash >> 27;
+    hash *= 0x94D049BB133111EBULL;
+    hash ^= hash >> 31;
+    return hash;
+}
+
+uint32_t FrozenIni::Reduce(uint32_t hash, uint32_t range) noexcept
+{
+    return static_cast<uint32_t>((static_cast<uint64_t>(hash)*range) >> 32);
+}
+
+uint32_t FrozenIni::GetBucket(uint64_t hash, uint32_t bucket_count) noexcept
+{
+    return Reduce(static_cast<uint32_t>(hash >> 32), bucket_count);
+}
+
+uint32_t FrozenIni::GetSlot(uint64_t hash, uint32_t displacement, uint32_t slot_count) noexcept
+{
+    return Reduce(static_cast<uint32_t>(Mix(hash + displacement*0x9E3779B97F4A7C15ULL)), slot_count);
+}
+
+bool FrozenIni::BuildPerfectHash(const std::vector<uint64_t>& hashes, uint32_t bucket_count, uint32_t slot_count,
+                                 std::vector<uint32_t>& displacements, std::vector<uint32_t>& slots)
+{
+    std::vector<std::vector<uint32_t>> buckets(bucket_count);
+    for(uint32_t i = 0; i < hashes.size(); ++i)
+    {
+        buckets[GetBucket(hashes[i], bucket_count)].push_back(i);
+    }
+
+    // Large buckets first, while most slots are still free.
+    std::vector<uint32_t> bucket_order(bucket_count);
+    for(uint32_t i = 0; i < bucket_count; ++i)
+    {
+        bucket_order[i] = i;
+    }
+    std::stable_sort(bucket_order.begin(), bucket_order.end(), [&](uint32_t a, uint32_t b)
+    {
+        return buckets[a].size() > buckets[b].size();
+    });
+
+    displacements.assign(bucket_count, 0);
+    slots.assign(slot_count, empty_slot);
+
+    const uint32_t max_displacement = 16*slot_count + 1024;
+    std::vector<uint32_t> candidates;
+    for(uint32_t bucket_index : bucket_order)
+    {
+        const std::vector<uint32_t>& bucket = buckets[bucket_index];
+        if(bucket.empty())
+        {
+            break;
+        }
+
+        bool is_placed = false;
+        for(uint32_t displacement = 0; displacement < max_displacement && !is_placed; ++displacement)
+        {
+            candidates.clear();
+            is_placed = true;
+            for(uint32_t entry_index : bucket)
+            {
+                uint32_t slot = GetSlot(hashes[entry_index], displacement, slot_count);
+                if(slots[slot] != empty_slot || std::find(candidates.begin(), candidates.end(), slot) != candidates.end())
+                {
+                    is_placed = false;
+                    break;
+                }
+                candidates.push_back(slot);
+            }
+
+            if(is_placed)
+            {
+                for(size_t i = 0; i < bucket.size(); ++i)
+                {
+                    slots[candidates[i]] = bucket[i];
+                }
+                displacements[bucket_index] = displacement;
+            }
+        }
+
+        if(!is_placed)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+template<typename BufferT>
+FrozenIni FrozenIni::Build(const BufferT& buffer, const IniBufferBase::AccessReport* profile)
+{
+    // Collect all properties in map order.
+    struct Property
+    {
+        uint32_t section_index;
+        const std::string* key_name;
+        const Value_t* value;
+    };
+
+    std::vector<const std::string*> section_names;
+    std::vector<Property> properties;
+    for(const auto& section : buffer.sections_)
+    {
+        for(const auto& property : section.second.properties_)
+        {
+            properties.push_back(Property{static_cast<uint32_t>(section_names.size()), &property.first, &property.second});
+        }
+        section_names.push_back(&section.first);
+    }
+
+    // Read keys first, the most frequently read first. The others keep the map order.
+    std::vector<size_t> order(properties.size());
+    for(size_t i = 0; i < order.size(); ++i)
+    {
+        order[i] = i;
+    }
+
+    size_t hot_count = 0;
+    if(profile != nullptr)
+    {
+        std::map<std::string, std::map<std::string, size_t>> ranks;
+        for(size_t rank = 0; rank < profile->hot_keys.size(); ++rank)
+        {
+            ranks[profile->hot_keys[rank].section_name].emplace(profile->hot_keys[rank].key_name, rank);
+        }
+
+        std::vector<size_t> property_ranks(properties.size(), std::numeric_limits<size_t>::max());
+        for(size_t i = 0; i < properties.size(); ++i)
+        {
+            auto section = ranks.find(*section_names[properties[i].section_index]);
+            if(section != ranks.end())
+            {
+                auto key = section->second.find(*properties[i].key_name);
+                if(key != section->second.end())
+                {
+                    property_ranks[i] = key->second;
+                    ++hot_count;
+                }
+            }
+        }
+
+        std::stable_sort(order.begin(), order.end(), [&property_ranks](size_t a, size_t b)
+        {
+            return property_ranks[a] < property_ranks[b];
+        });
+    }
+
+    // String region: names and short values of the hot properties, then of the cold properties, then long values.
+    std::string strings;
+    auto append_string = [&strings](const std::string& str) -> uint32_t
+    {
+        uint32_t offset = static_cast<uint32_t>(strings.size());
+        strings.append(str);
+        strings.push_back('\0');
+        return offset;
+    };
+
+    std::vector<SectionEntry> sections(section_names.size(), SectionEntry{empty_slot, 0});
+    auto append_section_name = [&](uint32_t section_index)
+    {
+        if(sections[section_index].name_offset == empty_slot)
+        {
+            sections[section_index] = SectionEntry{append_string(*section_names[section_index]), static_cast<uint32_t>(section_names[section_index]->size())};
+        }
+    };
+
+    std::vector<Entry> entries(properties.size());
+    for(size_t i = 0; i < order.size(); ++i)
+    {
+        const Property& property = properties[order[i]];
+        const std::string& value_string = property.value->GetValueAsString();
+        append_section_name(property.section_index);
+
+        Entry& entry = entries[i];
+        std::memset(&entry, 0, sizeof(entry));
+        entry.section_index = property.section_index;
+        entry.key_offset = append_string(*property.key_name);
+        entry.key_size = static_cast<uint32_t>(property.key_name->size());
+        entry.value_offset = value_string.size() <= long_string_size ? append_string(value_string) : empty_slot;
+        entry.value_size = static_cast<uint32_t>(value_string.size());
+        entry.type = static_cast<uint8_t>(property.value->GetType());
+
+        // Values which fail to convert are converted again on access to report the error.
+        try
+        {
+            switch(property.value->GetType())
+            {
+                case IniBuffer::DataType::INT: entry.int_value = property.value->template GetValue<int>(); entry.is_converted = 1; break;
+                case IniBuffer::DataType::FLOAT: entry.float_value = property.value->template GetValue<float>(); entry.is_converted = 1; break;
+                case IniBuffer::DataType::BOOL: entry.bool_value = property.value->template GetValue<bool>() ? 1 : 0; entry.is_converted = 1; break;
+                default: break;
+            }
+        }
+        catch(const IniException& e){entry.is_converted = 0;}
+    }
+
+    for(uint32_t section_index = 0; section_index < sections.size(); ++section_index)
+    { // Sections without properties.
+        append_section_name(section_index);
+    }
+
+    for(size_t i = 0; i < order.size(); ++i)
+    {
+        Entry& entry = entries[i];
+        entry.section_offset = sections[entry.section_index].name_offset;
+        entry.section_size = sections[entry.section_index].name_size;
+        if(entry.value_offset == empty_slot)
+        {
+            entry.value_offset = append_string(properties[order[i]].value->GetValueAsString());
+        }
+    }
+
+    if(strings.size() > std::numeric_limits<uint32_t>::max() || entries.size() >= empty_slot)
+    {
+        throw INI_EXCEPTION("Buffer is too large to be frozen.");
+    }
+
+    // Perfect hash. If no displacements are found, retry with another seed and every second time with more slots.
+    // After max_attempts the slots outnumber the entries by far, failing further means the hashes collide completely.
+    const uint32_t max_attempts = 64;
+    const uint32_t entry_count = static_cast<uint32_t>(entries.size());
+    const uint32_t bucket_count = entry_count/4 + 1;
+    uint32_t slot_count = std::max<uint32_t>(entry_count, 1);
+    uint64_t seed = 0;
+    std::vector<uint64_t> hashes(entry_count);
+    std::vector<uint32_t> displacements;
+    std::vector<uint32_t> slots;
+    for(uint32_t attempt = 0; ; ++attempt)
+    {
+        if(attempt == max_attempts || slot_count >= empty_slot/2)
+        {
+            throw INI_EXCEPTION("No perfect hash found for " + std::to_string(entry_count) + " entries after " + std::to_string(attempt) + " attempts.");
+        }
+        seed = Mix(attempt + 1);
+        for(uint32_t i = 0; i < entry_count; ++i)
+        {
+            const char* section_name = strings.data() + entries[i].section_offset;
+            const char* key_name = strings.data() + entries[i].key_offset;
+            hashes[i] = Hash(section_name, entries[i].section_size, key_name, entries[i].key_size, seed);
+            entries[i].hash = hashes[i];
+        }
+
+        if(BuildPerfectHash(hashes, bucket_count, slot_count, displacements, slots))
+        {
+            break;
+        }
+        if(attempt % 2 == 1)
+        {
+            slot_count += slot_count/8 + 1;
+        }
+    }
+
+    // Layout: [Header][Sections][Entries][Displacements][Slots][Strings], every region aligned to 8 bytes.
+    // Entries and strings start at a cache line, so the hot ones at their front share as few cache lines as possible.
+    auto align = [](uint64_t offset) -> uint64_t {return (offset + 7) & ~static_cast<uint64_t>(7);};
+    auto align_to_cache_line = [](uint64_t offset) -> uint64_t {return (offset + cache_line_size - 1) & ~(cache_line_size - 1);};
+
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    header.magic = image_magic;
+    header.layout_version = image_version;
+    header.section_count = static_cast<uint32_t>(sections.size());
+    header.entry_count = entry_count;
+    header.bucket_count = bucket_count;
+    header.slot_count = slot_count;
+    header.seed = seed;
+    header.sections_offset = align(sizeof(Header));
+    header.entries_offset = align_to_cache_line(header.sections_offset + sections.size()*sizeof(SectionEntry));
+    header.displacements_offset = align(header.entries_offset + entries.size()*sizeof(Entry));
+    header.slots_offset = align(header.displacements_offset + displacements.size()*sizeof(uint32_t));
+    header.strings_offset = align_to_cache_line(header.slots_offset + slots.size()*sizeof(uint32_t));
+    header.image_size = align(header.strings_offset + strings.size());
+
+    // The image starts at a cache line inside of the storage. uint64_t elements keep the storage aligned to 8 bytes.
+    const size_t storage_size = (header.image_size + cache_line_size)/sizeof(uint64_t);
+    std::shared_ptr<uint64_t> storage(new uint64_t[storage_size](), std::default_delete<uint64_t[]>());
+    char* image = reinterpret_cast<char*>(storage.get());
+    image += align_to_cache_line(reinterpret_cast<uintptr_t>(image)) - reinterpret_cast<uintptr_t>(image);
+
+    std::memcpy(image, &header, sizeof(header));
+    std::memcpy(image + header.sections_offset, sections.data(), sections.size()*sizeof(SectionEntry));
+    std::memcpy(image + header.entries_offset, entries.data(), entries.size()*sizeof(Entry));
+    std::memcpy(image + header.displacements_offset, displacements.data(), displacements.size()*sizeof(uint32_t));
+    std::memcpy(image + header.slots_offset, slots.data(), slots.size()*sizeof(uint32_t));
+    std::memcpy(image + header.strings_offset, strings.data(), strings.size());
+
+    return FrozenIni(storage, image);
+}
+#endif
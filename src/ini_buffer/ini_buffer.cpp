@@ -1 +1,2 @@
 #include"ini_buffer.h"
+#include"ini_stack.h"
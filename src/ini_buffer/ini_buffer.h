@@ -8,10 +8,36 @@
 #ifndef INI_BUFFER_H_
 #define INI_BUFFER_H_
 
+#include<algorithm>
+#include<atomic>
+#include<cerrno>
+#include<cstdint>
+#include<cstring>
+#include<exception>
 #include<fstream>
+#include<functional>
 #include<iostream>
+#include<limits>
+#include<list>
 #include<map>
+#include<memory>
+#include<mutex>
+#include<set>
 #include<stdexcept>
+#include<sys/stat.h>
+#include<sys/types.h>
+#include<system_error>
+#include<thread>
+#include<type_traits>
+#include<vector>
+#if !defined(_WIN32)
+#include<fcntl.h>
+#include<unistd.h>
+#endif
+#if defined(__linux__)
+#include<sys/sendfile.h>
+#endif
+#include"ini_storage.h"
 #include"str_manip.h"
 
 //===================================================================================
@@ -24,6 +50,152 @@ const bool ini_buffer_logger_on = false;
 /// Loggs a message in the format [Line: <line_nr>][Msg: <message>]. Logger is turned off by default.
 #define LOG(message) if(ini_buffer_logger_on)do{std::cout<<"[Line: "<<__LINE__<<"][Msg: "<<message<<"]\n";}while(0)
 
+//-----------------------------------------------------------------------------------
+// File status to detect modified files.
+
+namespace internal
+{
+    /// State of a file on disk. A file is considered unchanged as long as all members are equal.
+    struct FileStamp
+    {
+        std::string fullfilename;
+        long long size;
+
+        /// Time of the last modification in nanoseconds, so writes within the same second are detected.
+        long long mtime_ns;
+        unsigned long long inode;
+    };
+
+    /** Reads the state of a file on disk.
+    *
+    *   @details
+    *   Returns false if the file can not be accessed.
+    */
+    bool GetFileStamp(const std::string& fullfilename, FileStamp& stamp) noexcept;
+
+#if !defined(_WIN32)
+    /// Writes data at an offset of an open file with pwrite. Partial writes are continued. Returns false if writing failed.
+    bool WriteAt(int file_descriptor, const char* data, size_t size, size_t offset) noexcept;
+
+    /** Copies a byte range between two open files without passing it through user space where possible.
+    *
+    *   @details
+    *   Uses copy_file_range, then sendfile, then pread and pwrite, whatever is supported. Returns false if copying failed.
+    */
+    bool CopyRange(int source_fd, size_t source_offset, int destination_fd, size_t destination_offset, size_t size) noexcept;
+#endif
+
+    /// Byte range of a section in a file. Comments and blank lines in front of the header belong to the section.
+    struct SectionRange
+    {
+        std::string section_name;
+
+        /// Beginning of the comments in front of the header. Equal to header for the first section.
+        size_t begin;
+
+        /// Beginning of the header line.
+        size_t header;
+
+        /// Beginning of the next section or the end of the file.
+        size_t end;
+    };
+
+    /** Finds the byte ranges of all sections of a file, in file order.
+    *
+    *   @details
+    *   A section which appears several times has several ranges. Throws an IniException if the file can not be read,
+    *   @n is invalid or contains include directives.
+    *
+    *   @param ends_with_line_break Is set if the file is empty or its last byte is a line break.
+    */
+    std::vector<SectionRange> FindSectionRanges(const std::string& fullfilename, size_t file_size, bool& ends_with_line_break);
+
+    /// Reusable names for lookups with C strings. Assigning into them does not allocate once their capacity is sufficient.
+    struct LookupKeys
+    {
+        std::string section_name;
+        std::string key_name;
+    };
+
+    /** Borrows lookup keys of the calling thread for the lifetime of the scope.
+    *
+    *   @details
+    *   Every thread keeps a stack of lookup keys. Nested scopes, e.g. a lookup with C strings inside a subscription callback
+    *   @n of an EraseSection with C strings, use different keys and do not overwrite the names of the outer lookup.
+    *   @n Only the first scope of each nesting depth allocates.
+    */
+    class LookupKeysScope
+    {
+        public:
+
+        LookupKeysScope();
+        ~LookupKeysScope() noexcept;
+
+        LookupKeysScope(const LookupKeysScope&) = delete;
+        LookupKeysScope& operator=(const LookupKeysScope&) = delete;
+
+        /// The borrowed keys.
+        LookupKeys& keys;
+
+        private:
+
+        /// Lookup keys of one thread, indexed by the nesting depth of the scopes.
+        struct Stack
+        {
+            std::vector<std::unique_ptr<LookupKeys>> keys;
+            size_t depth = 0;
+        };
+
+        /// Returns the stack of the calling thread.
+        static Stack& GetStack() noexcept;
+
+        /// Returns the keys of the next nesting depth and enters it.
+        static LookupKeys& Acquire();
+    };
+
+    /** Counts lookups of missing keys per section and key while access profiling is enabled.
+    *
+    *   @details
+    *   Lookups of present keys are counted by the stored values themselves, see StringifiedValue::CountRead().
+    *   @n Every thread counts into one of several shards, so concurrent readers rarely wait for each other.
+    */
+    class AccessProfile
+    {
+        public:
+
+        /// Data type alias for counts [section_name | [key_name | count]].
+        using Counts_t = std::map<std::string, std::map<std::string, uint64_t>>;
+
+        /// Counts a lookup of a missing key.
+        void RecordMiss(const std::string& section_name, const std::string& key_name);
+
+        /// Sums up the counts of all shards.
+        void Collect(Counts_t& misses) const;
+
+        private:
+
+        /// Number of shards. Threads are assigned round robin.
+        static constexpr size_t shard_count = 16;
+
+        struct Shard
+        {
+            std::mutex mutex;
+            Counts_t misses;
+
+            /// Keeps shards of different threads on different cache lines.
+            char padding[64];
+        };
+
+        /// Increments the count of a key. Allocates only when a key is counted the first time.
+        static void Increment(Counts_t& counts, const std::string& section_name, const std::string& key_name);
+
+        /// Returns the shard of the calling thread.
+        Shard& GetShard() noexcept;
+
+        Shard shards_[shard_count];
+    };
+}
+
 //-----------------------------------------------------------------------------------
 // Exception for IniBuffer class errors.
 
@@ -48,687 +220,3008 @@ class IniException: public std::exception
 };
 
 //===================================================================================
-// IniBuffer class declaration
+// IniReader class declaration
 
-/** Represents the data structure of a classical ini file.
-*   @n The class supports reading and writing complete files as well as access and modifying the data members in a very easy way.
-*   @n Accessed data is automatically type casted. Supported are ints, floats, strings and bools.
-*   @n Errors are reported using IniExceptions. A meaningful error message is provided.
-*   @n You can find more info in the read me.
+/** Receives the events of an IniReader.
+*
+*   @details
+*   Override the events of interest. The default implementations ignore the event.
+*   @n The views passed to the events point into the input and are only valid during the call.
+*   @n An event may throw an IniException to abort reading.
 */
-class IniBuffer
+class IniHandler
 {
-    private:
+    public:
 
-    /// Forward declaration for internal data structure section.
-    class Section;
+    virtual ~IniHandler() noexcept;
 
-    /// Data type alias for the names of the section.
-    using section_name_t = std::string;
+    /// A section header [section_name] was read.
+    virtual void OnSection(const StringView& section_name, size_t line_nr);
 
-    /// Data type alias for the [section_name | section_data] map.
-    using SectionMap_t = std::map<section_name_t, Section>;
+    /// A property key_name = value was read. Properties are always preceded by at least one section.
+    virtual void OnProperty(const StringView& key_name, const StringView& value, size_t line_nr);
 
-    public:
+    /// A comment was read. The comment text excludes the delimiter and surrounding white spaces.
+    virtual void OnComment(const StringView& comment, size_t line_nr);
 
-    /// List of supported data types for internal communication.
-    enum DataType
-    {
-        STRING = 0,
-        INT = 10,
-        FLOAT = 20,
-        BOOL = 40,
-        EMPTY = 50
-    };
+    /// An include directive !include <path> was read. The path is passed as written in the file.
+    virtual void OnInclude(const StringView& path, size_t line_nr);
+};
 
-    //===================================================================================
-    // Begin of public IniBuffer Interface
+/** Streaming tokenizer for ini files.
+*
+*   @details
+*   The input is split into lines and interpreted without materializing the content.
+*   @n Sections, properties, comments and include directives are reported to an IniHandler.
+*   @n Memory usage is constant regardless of the input size. Only a line which spans two consecutive
+*   @n chunks of input is copied to an internal buffer.
+*   @n Syntax errors are reported using IniExceptions.
+*/
+class IniReader
+{
+    public:
 
-    /** Loads a specified ini file and parses it into the buffer.
-    *
-    *   @param fullfilename The path and filename pointing to the configuration file.
-    */
-    void LoadFile(const std::string& fullfilename);
+    /// Constructs a reader which reports all events to a handler. The handler must outlive the reader.
+    explicit IniReader(IniHandler& handler) noexcept;
 
-    /** Writes the internal buffer state into the specified file.
-    *   @details
-    *   @n The specified path (not the file) must exist.
-    *   @n If an error occurres during parsing or opening the file, an IniException is thrown.
+    /** Reads a whole file from disk in fixed size chunks.
     *
-    *   @param fullfilename The path and filename pointing to the configuration file.
+    *   @details
+    *   If the file can not be opened or read, an IniException is thrown.
     */
-    void WriteFile(const std::string& fullfilename) const;
-
-    /// Clears the whole state of the IniBuffer object.
-    void Clear() noexcept;
-
-    /// Delets a whole section in the buffer.
-    void EraseSection(const std::string& section_name) noexcept;
+    void ReadFile(const std::string& fullfilename);
 
-    /// Delets a key/value pair in the buffer.
-    void EraseProperty(const std::string& section_name, const std::string& key_name) noexcept;
-
-    /** Receive a requested value from the buffer.
+    /** Reads a whole stream in fixed size chunks until its end.
     *
     *   @details
-    *   The requested data member is automatically casted to the requested type.
-    *   @n If the requested type is inconsistent with the value, an IniException is thrown.
-    *
-    *   @param_t ValueT The type of the requested data member. Supported are {int, float, std::string, bool}
-    *
-    *   @param section_name Name of the section, in which the value is stored in the ini file.
-    *   @param key_name Name of the property key where the value is stored in the ini file.
-    *
-    *   @return The requested value casted to the specified type ValueT.
+    *   If reading from the stream fails, an IniException is thrown.
     */
-    template<typename ValueT>
-    ValueT GetValue(const std::string& section_name, const std::string& key_name) const;
+    void ReadStream(std::istream& stream);
 
-    /** Inserts a certain value into the ini file buffer.
+    /** Reads the next chunk of input.
     *
     *   @details
-    *   If an error occurred during the operation an IniException is thrown.
-    *
-    *   @param_t ValueT The type of the inserted data member. Supported are {int, float, std::string, bool}
-    *
-    *   @param section_name Name of the section where the value is stored in the ini file.
-    *   @param key_name Name of the property key where the value is stored in the ini file.
-    *   @param value The value being inserted by the method.
+    *   The input may end in the middle of a line. It is continued with the next chunk. Call Finish after the last chunk.
     */
-    template<typename ValueT>
-    void AddValue(const std::string& section_name, const std::string& key_name, const ValueT& value);
+    void Read(const char* data, size_t size);
 
-    // End of public IniBuffer interface
-    //===================================================================================
+    /// Interprets the last line of the input and resets the reader for new input.
+    void Finish();
+
+    /// Byte offset of the interpreted line from the beginning of the input. Valid during the events.
+    size_t GetLineOffset() const noexcept;
+
+    /// Byte offset behind the line break of the interpreted line. Valid during the events.
+    size_t GetLineEndOffset() const noexcept;
+
+    /// Checks if the last input ended with a line break or was empty. Stays valid after Finish().
+    bool EndsWithLineBreak() const noexcept;
 
     private:
 
-    class Section
+    /// Size of the chunks read from files.
+    static constexpr size_t chunk_size = 64*1024;
+
+    /// Interprets a single line without the line break.
+    void ReadLine(StringView line);
+
+    /// Receives the events.
+    IniHandler& handler_;
+
+    /// Beginning of a line which continues in the next chunk.
+    std::string partial_line_;
+
+    /// Number of the last interpreted line.
+    size_t line_nr_;
+
+    /// Number of bytes of the input passed to Read so far.
+    size_t input_offset_;
+
+    /// Offset of the line stored in partial_line_.
+    size_t partial_line_offset_;
+
+    /// Offsets of the beginning and the end of the interpreted line.
+    size_t line_offset_;
+    size_t line_end_offset_;
+
+    /// Set as soon as the first section was read.
+    bool has_section_;
+
+    /// Set if the last chunk passed to Read ended with a line break.
+    bool ends_with_line_break_;
+};
+
+//===================================================================================
+// IniBuffer class declaration
+
+/// Immutable compact copy of an IniBuffer. Declared in frozen_ini.h.
+class FrozenIni;
+
+/// Ini buffer with selectable containers and allocator. See IniBuffer for the default.
+template<typename StoragePolicyT, typename AllocatorT>
+class BasicIniBuffer;
+
+/** Part of the BasicIniBuffer which does not depend on its storage.
+*   @n Contains the types of the interface, the stored values with their type conversions and the shared helpers.
+*   @n All instantiations of BasicIniBuffer exchange these types, e.g. an AccessReport or a BoundValue.
+*/
+class IniBufferBase
+{
+    public:
+
+    /// List of supported data types for internal communication.
+    enum DataType
     {
-        public:
+        STRING = 0,
+        INT = 10,
+        FLOAT = 20,
+        BOOL = 40,
+        EMPTY = 50
+    };
 
-        /// Constructs a section which is a nested data structure of the IniBuffer.
-        Section() noexcept;
+    protected:
 
-        /// Constructs a named IniBuffer section.
-        Section(const std::string& section_name) noexcept;
+    /// Internal data structure of a single value, which is stored as a string and an auto detected data type.
+    class StringifiedValue
+    {
+        public:
 
-        ~Section() noexcept;
+        /// Creates a stringified value.
+        StringifiedValue(const std::string& value) noexcept;
 
-        /** Get the value from a property (key value pair) in the section.
-        *
-        *   @details
-        *   If an error occurred during the operation an IniException is thrown.
-        *
-        *   @param_t ValueT Data type of the requested value.
-        *   @param key_name Key of he requested value.
-        */
-        template<typename ValueT>
-        ValueT GetValue(const std::string& key_name) const;
+        /// Creates an empty stringified value.
+        StringifiedValue() noexcept;
 
-        /// Returns the name of this section.
-        const std::string& GetName() const noexcept;
+        /// Copies and moves take the read count along, so it stays with its key when a storage relocates values.
+        StringifiedValue(const StringifiedValue& other);
+        StringifiedValue(StringifiedValue&& other) noexcept;
+        StringifiedValue& operator=(const StringifiedValue& other);
+        StringifiedValue& operator=(StringifiedValue&& other) noexcept;
 
-        /** Adds a new property [key | value pair] to the section.
-        *
-        *   @details
-        *   A new property is added or an existing one updated.
+        ~StringifiedValue() noexcept;
+
+        /** Get this value casted in the specified type ValueT.
         *
-        *   @param key Name of the key where the new value should be stored.
-        *   @param value The value which belongs to the key as string. (type is detected at insertion.)
+        * @details
+        * If the function fails, an IniException is thrown.
         */
-        void AddProperty(const std::string& key, const std::string& value) noexcept;
+        template<typename ValueT>
+        ValueT GetValue() const;
 
-        /// Deletes a key|vaue pair.
-        void EraseProperty(const std::string& key) noexcept;
+        /// Same as GetValue but does not perform typecasting to ValueT.
+        const std::string& GetValueAsString() const noexcept;
 
-        /// Writes this section to the file.
-        void WriteSection(std::ofstream& file);
+        /// Returns the auto detected data type of the value.
+        DataType GetType() const noexcept;
 
-        private:
+        /// Same as GetValue<std::string> but returns a reference to the stored string instead of a copy.
+        const std::string& GetStringRef() const;
 
-        /// Internal data structure of a single value, which is stored as a string and an auto detected data type.
-        class StringifiedValue
-        {
-            public:
+        /// Replaces the stored string and its data type. The read count is kept.
+        void SetValue(const std::string& value);
 
-            /// Creates a stringified value.
-            StringifiedValue(const std::string& value) noexcept;
+        /// Counts a lookup of this value. Thread safe, the count saturates instead of wrapping around.
+        void CountRead() const noexcept;
 
-            /// Creates an empty stringified value.
-            StringifiedValue() noexcept;
+        /// Returns the number of counted lookups.
+        uint32_t GetReadCount() const noexcept;
 
-            ~StringifiedValue() noexcept;
+        /// Sets the number of counted lookups to 0.
+        void ResetReadCount() noexcept;
 
-            /** Get this value casted in the specified type ValueT.
-            *
-            * @details
-            * If the function fails, an IniException is thrown.
-            */
-            template<typename ValueT>
-            ValueT GetValue() const;
+        private:
 
-            /// Same as GetValue but does not perform typecasting to ValueT.
-            const std::string& GetValueAsString() const noexcept;
+        /** Underlaying function which casts the stored strings of the values to the requested data type.
+        *
+        *   @details
+        *   If the cast is not successful an IniBufferException is thrown.
+        */
+        template<typename ValueT>
+        ValueT CastValue() const;
 
-            private:
+        /// The data type specification of this stringified value.
+        DataType type_;
 
-            /** Underlaying function which casts the stored strings of the values to the requested data type.
-            *
-            *   @details
-            *   If the cast is not successful an IniBufferException is thrown.
-            */
-            template<typename ValueT>
-            ValueT CastValue() const;
+        /// Lookups counted while access profiling is enabled. Fills the padding behind type_.
+        mutable std::atomic<uint32_t> read_count_;
 
-            /// The data type specification of this stringified value.
-            DataType type_;
+        /// The stored value.
+        std::string value_;
+    };
 
-            /// The stored value.
-            std::string value_;
-        };
+    /// Cell of a bound value. Updated by the buffer when the bound property changes.
+    struct BoundCellBase
+    {
+        BoundCellBase(const std::string& section_name, const std::string& key_name);
+        virtual ~BoundCellBase() = default;
 
-        /// Data type alias for keys.
-        using KeyName_t = std::string;
+        /// Reads the bound property again after it changed. Keeps the last value if it is not convertible anymore.
+        virtual void Update(const StringifiedValue& stored_value) noexcept = 0;
 
-        /// Data type alias for the map of properties [Key | Value pairs].
-        using PropertyMap_t = std::map<KeyName_t,  StringifiedValue>;
+        const std::string section_name;
+        const std::string key_name;
+    };
 
-        /// Name of this section.
-        std::string name_;
+    /// Cell of a bound value of a certain type.
+    template<typename ValueT>
+    struct BoundCell: public BoundCellBase
+    {
+        BoundCell(const std::string& section_name, const std::string& key_name, ValueT initial_value);
+        void Update(const StringifiedValue& stored_value) noexcept override;
 
-        /// Actual place where the properties (key/value pairs) are stored.
-        PropertyMap_t properties_;
+        std::atomic<ValueT> value;
     };
 
-    /** Inserting a new section to the IniBuffer.
-    *
-    *   @details
-    *   If already a section with the same name is present in the buffer, the old section will be overwritten.
-    */
-    void AddSection(const Section& section) noexcept;
+    public:
 
-    /// Interprets all lines of an ini configuration file and stores its content in the buffer.
-    void ParseFile(const std::string& fullfilename);
+    /// Identifier of a subscription.
+    using SubscriptionId = size_t;
 
-    /// Adds an empty section (without any properties) to the IniBuffer.
-    void AddEmptySection(const std::string& section_name) noexcept;
+    /// A property which was added, modified or erased.
+    struct Change
+    {
+        std::string section_name;
+        std::string key_name;
+    };
 
-    /** Converts any supported type into a std::string.
+    /// Receives all changes of a batch which match a subscription.
+    using Callback_t = std::function<void(const std::vector<Change>& changes)>;
+
+    /** Handle to a value which follows the content of the buffer. Created by Bind().
     *
     *   @details
-    *   This function throws an IniException if it fails.
-    *   @n Supported Types are: {int, bool, float, std::string;}
+    *   Reading it is a single relaxed atomic load without any lookup or lock, also from other threads.
+    *   @n Copies share the same cell. The handle stays valid after the buffer was destroyed and keeps its last value.
     */
     template<typename ValueT>
-    std::string Stringify(const ValueT& value) const;
+    class BoundValue
+    {
+        template<typename, typename> friend class BasicIniBuffer;
 
-    /// A Map of sections with their names [section_name | section_object]
-    SectionMap_t sections_;
-};
+        public:
 
-/// Namespace for internal functions which are used by the IniBuffer Class.
-namespace internal
-{
-    /** Finds the data type of a string.
-    *
-    *   @details
-    *   Used internally by the IniBuffer class.
-    */
-    IniBuffer::DataType GetDataType(const std::string& str) noexcept;
-}
+        /// Returns the current value.
+        ValueT Get() const noexcept;
 
-/** Gets the current DateTime and returns it in a formatted line.
-* @details
-* Format is: YYYY/MM/DD hh:mm:ss
+        private:
+
+        explicit BoundValue(std::shared_ptr<const BoundCell<ValueT>> cell) noexcept;
+
+        /// Cell updated by the buffer.
+        std::shared_ptr<const BoundCell<ValueT>> cell_;
+    };
+
+    /// Number of lookups of a key.
+    struct AccessCount
+    {
+        std::string section_name;
+        std::string key_name;
+        uint64_t count;
+    };
+
+    /// Result of the access profiling. See EnableAccessProfiling().
+    struct AccessReport
+    {
+        /// Keys which were read, the most frequently read first.
+        std::vector<AccessCount> hot_keys;
+
+        /// Keys which are present but were never read. Their count is 0.
+        std::vector<AccessCount> unread_keys;
+
+        /// Lookups of keys which were not present, the most frequent first.
+        std::vector<AccessCount> missing_keys;
+    };
+
+    protected:
+
+    /// State which is passed through nested ParseFile calls while resolving include directives.
+    struct IncludeContext
+    {
+        /// Files which are currently parsed. Used to detect include cycles.
+        std::vector<std::string> chain;
+
+        /// All files the parsed content depends on.
+        std::vector<internal::FileStamp> dependencies;
+    };
+
+    /// Maximal nesting depth of include directives.
+    static constexpr size_t max_include_depth = 32;
+
+    /// Serialized size of the chunks a parallel WriteFile formats and writes at once.
+    static constexpr size_t write_chunk_size = 4*1024*1024;
+
+    /// Smaller content is written by the calling thread, since starting threads would cost more than they save.
+    static constexpr size_t parallel_write_min_size = 2*write_chunk_size;
+
+    /// Returns the comment header written in front of the content, or an empty string.
+    static std::string CreateHeader(bool with_header);
+
+    /** Assigns names given as C strings to borrowed lookup keys.
+    *
+    *   @details
+    *   If a name is a nullptr, an IniException is thrown.
+    */
+    static void AssignLookupKeys(internal::LookupKeys& keys, const char* section_name, size_t section_name_length, const char* key_name, size_t key_name_length);
+
+    /** Converts any supported type into a std::string.
+    *
+    *   @details
+    *   This function throws an IniException if it fails.
+    *   @n Supported Types are: {int, bool, float, std::string;}
+    */
+    template<typename ValueT>
+    static std::string Stringify(const ValueT& value);
+};
+
+/** Represents the data structure of a classical ini file.
+*   @n The class supports reading and writing complete files as well as access and modifying the data members in a very easy way.
+*   @n Accessed data is automatically type casted. Supported are ints, floats, strings and bools.
+*   @n Errors are reported using IniExceptions. A meaningful error message is provided.
+*   @n You can find more info in the read me.
+*
+*   @param_t StoragePolicyT Containers of sections and properties. See OrderedStorage, HashedStorage and SortedVectorStorage.
+*   @param_t AllocatorT Allocator of the containers. It is rebound to their items and must be default constructible.
+*            @n Only the container nodes or arrays are allocated with it. Names and values are std::strings, which
+*            @n allocate their characters with std::allocator once they exceed the small string buffer.
 */
-static std::string GetDateTime() noexcept;
+template<typename StoragePolicyT = OrderedStorage, typename AllocatorT = std::allocator<char>>
+class BasicIniBuffer: public IniBufferBase
+{
+    /// The IniStack resolves values directly from the internal data structure of its layers.
+    friend class IniStack;
 
+    /// The IniCache parses files and resolves include directives on behalf of the buffer.
+    friend class IniCache;
 
-//===================================================================================
-// Implementation
+    /// The FrozenIni packs the internal data structure into its image.
+    friend class FrozenIni;
 
-//-----------------------------------------------------------------------------------
-// IniException
+    /// Buffers of other storages merge included content from the IniCache.
+    template<typename, typename> friend class BasicIniBuffer;
+
+    public:
+
+    /// The storage policy of the buffer.
+    using StoragePolicy_t = StoragePolicyT;
+
+    private:
+
+    /// Forward declaration for internal data structure section.
+    class Section;
+
+    /// Data type alias for the names of the section.
+    using section_name_t = std::string;
+
+    /// Data type alias for the [section_name | section_data] map.
+    using SectionMap_t = typename StoragePolicyT::template Map_t<section_name_t, Section, AllocatorT>;
+
+    public:
+
+    //===================================================================================
+    // Begin of public IniBuffer Interface
+
+    /** Loads a specified ini file and parses it into the buffer.
+    *
+    *   @param fullfilename The path and filename pointing to the configuration file.
+    */
+    void LoadFile(const std::string& fullfilename);
+
+    /** Parses ini content from memory into the buffer. The content is not copied.
+    *
+    *   @details
+    *   Relative paths of include directives are interpreted relative to base_directory,
+    *   @n or relative to the current working directory if it is empty.
+    *
+    *   @param data Pointer to the content. It does not need to be null terminated.
+    *   @param size Number of characters of the content.
+    *   @param base_directory Directory which relative include paths are interpreted relative to.
+    */
+    void LoadFromBuffer(const char* data, size_t size, const std::string& base_directory = std::string());
+
+    /// Same as LoadFromBuffer for content stored in a std::string.
+    void LoadFromString(const std::string& content, const std::string& base_directory = std::string());
+
+    /** Parses ini content from a stream until its end, e.g. a pipe or a decompressing stream.
+    *
+    *   @details
+    *   The stream is read in fixed size chunks. Relative paths of include directives are interpreted relative to base_directory,
+    *   @n or relative to the current working directory if it is empty.
+    */
+    void LoadFromStream(std::istream& stream, const std::string& base_directory = std::string());
+
+    /** Moves the content of a buffer which was loaded separately, e.g. by another thread, into this buffer.
+    *
+    *   @details
+    *   The result is the same as if this buffer had loaded the content itself. Sections of the loaded buffer replace
+    *   @n sections with the same name and subscribers are notified. If this buffer is empty, it takes over the change
+    *   @n tracking of the loaded buffer for Save. The loaded buffer is left empty.
+    */
+    void Adopt(BasicIniBuffer&& loaded);
+
+    /** Writes the internal buffer state into the specified file.
+    *   @details
+    *   @n The specified path (not the file) must exist.
+    *   @n If an error occurres during parsing or opening the file, an IniException is thrown.
+    *   @n Content of at least two chunks of 4 MB is formatted by several threads. Each thread formats whole sections
+    *   @n into its own buffer and writes it with pwrite at the offset precomputed from the section sizes. The output
+    *   @n is the same as with one thread. On Windows the content is always written by the calling thread.
+    *
+    *   @param fullfilename The path and filename pointing to the configuration file.
+    *   @param with_header Writes a comment header with the current date and time. Without it, the output is deterministic.
+    *   @param thread_count Maximal number of threads. 0 uses one thread per core.
+    */
+    void WriteFile(const std::string& fullfilename, bool with_header = true, size_t thread_count = 0) const;
+
+    /** Serializes the internal buffer state into a new string.
+    *
+    *   @param with_header Writes a comment header with the current date and time. Without it, the output is deterministic.
+    */
+    std::string WriteToString(bool with_header = false) const;
+
+    /** Serializes the internal buffer state into a caller owned string, replacing its content.
+    *
+    *   @details
+    *   The buffer is reserved to the exact size once. Reusing the same buffer for repeated calls does not allocate
+    *   @n as long as its capacity is sufficient.
+    *
+    *   @param buffer Receives the serialized content.
+    *   @param with_header Writes a comment header with the current date and time. Without it, the output is deterministic.
+    */
+    void WriteToBuffer(std::string& buffer, bool with_header = false) const;
+
+    /** Serializes the internal buffer state into a stream.
+    *
+    *   @details
+    *   The content is written piece by piece without an intermediate copy. If writing fails, an IniException is thrown.
+    *
+    *   @param with_header Writes a comment header with the current date and time. Without it, the output is deterministic.
+    */
+    void WriteToStream(std::ostream& stream, bool with_header = false) const;
+
+    /// Clears the whole state of the IniBuffer object. Throws under the same conditions as EraseSection.
+    void Clear();
+
+    /** Starts counting the lookups of GetValue, GetStringRef and FindStoredValue per section and key. Previous counts are discarded.
+    *
+    *   @details
+    *   Counting is thread safe, but enabling and disabling must not happen while other threads read from the buffer.
+    *   @n Reads of present keys increment a relaxed atomic counter stored with the value, so the count of a property
+    *   @n is dropped when the property is erased or its section is replaced by a load. Lookups of missing keys are
+    *   @n counted per thread shard. While profiling is disabled, lookups only test a null pointer.
+    *   @n The profile belongs to the buffer object and is not copied with its content.
+    */
+    void EnableAccessProfiling();
+
+    /// Stops counting and discards the counts.
+    void DisableAccessProfiling() noexcept;
+
+    /// Returns the counted lookups. If profiling is not enabled, an IniException is thrown.
+    AccessReport GetAccessReport() const;
+
+    /** Writes a human readable report of hot, never read and missing keys.
+    *
+    *   @details
+    *   If profiling is not enabled or writing fails, an IniException is thrown.
+    *
+    *   @param max_hot_keys Maximal number of hot keys listed.
+    */
+    void WriteAccessReport(std::ostream& stream, size_t max_hot_keys = 20) const;
+
+    /// Returns an estimate of the heap memory in bytes occupied by the content of the buffer.
+    size_t GetMemoryUsage() const noexcept;
+
+    /** Packs the content into an immutable compact representation for fast lookups.
+    *
+    *   @details
+    *   All sections, keys and typed values are stored in one contiguous allocation. See FrozenIni.
+    *   @n Later modifications of the buffer do not affect the returned object.
+    */
+    FrozenIni Freeze() const;
+
+    /** Same as Freeze but lays the image out for the access pattern of a profile. See EnableAccessProfiling().
+    *
+    *   @details
+    *   Entries and strings of read keys are placed at the front of their regions, the most frequently read first,
+    *   @n starting at a cache line. Never read keys and long string values follow in separate regions,
+    *   @n so the lookups of the hot keys touch as few cache lines as possible.
+    */
+    FrozenIni Freeze(const AccessReport& profile) const;
+
+    /** Delets a whole section in the buffer.
+    *
+    *   @details
+    *   Erasing a section which is not present does nothing. Only throws if a subscriber callback throws,
+    *   @n or if recording the change for subscribers or Save() runs out of memory.
+    */
+    void EraseSection(const std::string& section_name);
+
+    /// Same as EraseSection but does not construct a temporary std::string from the name.
+    void EraseSection(const char* section_name);
+
+    /// Same as EraseSection but the name is given by a pointer and a length and does not need to be null terminated.
+    void EraseSection(const char* section_name, size_t section_name_length);
+
+    /** Delets a key/value pair in the buffer.
+    *
+    *   @details
+    *   Erasing a key which is not present, also in a section which is not present, does nothing.
+    *   @n Throws under the same conditions as EraseSection.
+    */
+    void EraseProperty(const std::string& section_name, const std::string& key_name);
+
+    /// Same as EraseProperty but does not construct temporary std::strings from the names.
+    void EraseProperty(const char* section_name, const char* key_name);
+
+    /// Same as EraseProperty but the names are given by pointers and lengths and do not need to be null terminated.
+    void EraseProperty(const char* section_name, size_t section_name_length, const char* key_name, size_t key_name_length);
+
+    /** Receive a requested value from the buffer.
+    *
+    *   @details
+    *   The requested data member is automatically casted to the requested type.
+    *   @n If the requested type is inconsistent with the value, an IniException is thrown.
+    *
+    *   @param_t ValueT The type of the requested data member. Supported are {int, float, std::string, bool}
+    *
+    *   @param section_name Name of the section, in which the value is stored in the ini file.
+    *   @param key_name Name of the property key where the value is stored in the ini file.
+    *
+    *   @return The requested value casted to the specified type ValueT.
+    */
+    template<typename ValueT>
+    ValueT GetValue(const std::string& section_name, const std::string& key_name) const;
+
+    /** Same as GetValue but does not construct temporary std::strings from the names.
+    *
+    *   @details
+    *   Lookups with string literals do not allocate. If a name is a nullptr, an IniException is thrown.
+    */
+    template<typename ValueT>
+    ValueT GetValue(const char* section_name, const char* key_name) const;
+
+    /// Same as GetValue but the names are given by pointers and lengths and do not need to be null terminated.
+    template<typename ValueT>
+    ValueT GetValue(const char* section_name, size_t section_name_length, const char* key_name, size_t key_name_length) const;
+
+    /** Receive a reference to a stored string value without copying it.
+    *
+    *   @details
+    *   If the value is not present or is not a string, an IniException is thrown.
+    *   @n The reference stays valid until the property is overwritten or erased, its section is erased or overwritten,
+    *   @n the buffer is cleared, loaded or destroyed. If StoragePolicyT::stable_references is true, adding other
+    *   @n properties or sections does not invalidate it. With SortedVectorStorage, every addition invalidates it.
+    *
+    *   @param section_name Name of the section, in which the value is stored in the ini file.
+    *   @param key_name Name of the property key where the value is stored in the ini file.
+    *
+    *   @return Read only reference to the stored string.
+    */
+    const std::string& GetStringRef(const std::string& section_name, const std::string& key_name) const;
+
+    /// Same as GetStringRef but does not construct temporary std::strings from the names.
+    const std::string& GetStringRef(const char* section_name, const char* key_name) const;
+
+    /// Same as GetStringRef but the names are given by pointers and lengths and do not need to be null terminated.
+    const std::string& GetStringRef(const char* section_name, size_t section_name_length, const char* key_name, size_t key_name_length) const;
+
+    /** Looks up the stored string of any value and its auto detected type without converting it.
+    *
+    *   @details
+    *   Returns nullptr if the value is not present. No exception is thrown.
+    *   @n The pointer stays valid as long as a reference returned by GetStringRef would.
+    *
+    *   @param type Receives the auto detected type of the value if it is present.
+    */
+    const std::string* FindStoredValue(const std::string& section_name, const std::string& key_name, DataType& type) const;
+
+    /** Calls a function for the name of every section, in storage order.
+    *
+    *   @details
+    *   The function is called as function(const std::string& section_name). It must not modify the buffer.
+    */
+    template<typename FunctionT>
+    void ForEachSection(FunctionT function) const;
+
+    /** Calls a function for every property of a section, in storage order, without converting the values.
+    *
+    *   @details
+    *   The function is called as function(const std::string& key_name, const std::string& value, DataType type)
+    *   @n with the stored string and its auto detected type. It must not modify the buffer.
+    *   @n If the section is not present, an IniException is thrown.
+    */
+    template<typename FunctionT>
+    void ForEachProperty(const std::string& section_name, FunctionT function) const;
+
+    /// Checks if a section is present.
+    bool HasSection(const std::string& section_name) const noexcept;
+
+    /// Returns the number of sections.
+    size_t GetSectionCount() const noexcept;
+
+    /** Inserts a certain value into the ini file buffer.
+    *
+    *   @details
+    *   If an error occurred during the operation an IniException is thrown.
+    *
+    *   @param_t ValueT The type of the inserted data member. Supported are {int, float, std::string, bool}
+    *
+    *   @param section_name Name of the section where the value is stored in the ini file.
+    *   @param key_name Name of the property key where the value is stored in the ini file.
+    *   @param value The value being inserted by the method.
+    */
+    template<typename ValueT>
+    void AddValue(const std::string& section_name, const std::string& key_name, const ValueT& value);
+
+    /** Same as AddValue but does not construct temporary std::strings from the names.
+    *
+    *   @details
+    *   Updating a present property with string literals does not allocate for the names. If a name is a nullptr, an IniException is thrown.
+    */
+    template<typename ValueT>
+    void AddValue(const char* section_name, const char* key_name, const ValueT& value);
+
+    /** Registers a callback which is notified about changes of a property or of all properties of a section.
+    *
+    *   @details
+    *   AddValue, EraseProperty, EraseSection, Clear and all Load functions report added, modified and erased properties.
+    *   @n Storing an unchanged value is not reported. A load only reports the properties which differ from the content before.
+    *   @n Changes are collected until the outermost batch ends, see BeginBatch(). Every callback is called once per batch
+    *   @n with all matching changes, each property at most once. A mutation outside a batch is a batch on its own.
+    *   @n Exceptions thrown by a callback are passed to the caller of the mutation.
+    *   @n Subscriptions belong to the buffer object. They are neither copied nor replaced by assignments.
+    *   @n Without subscriptions, mutations do not record anything and lookups are not affected at all.
+    *
+    *   @param section_name Name of the observed section.
+    *   @param key_name Name of the observed key, or "*" to observe all keys of the section.
+    *   @param callback Function receiving the changes.
+    *
+    *   @return Identifier to unsubscribe.
+    */
+    SubscriptionId Subscribe(const std::string& section_name, const std::string& key_name, Callback_t callback);
+
+    /** Binds a property to a handle which is updated in place whenever the property changes.
+    *
+    *   @details
+    *   Updates happen on the same events as the notifications of Subscribe(), before the callbacks are called.
+    *   @n If the property is erased or its new value cannot be converted to ValueT, the handle keeps its last value.
+    *   @n If the property is not present or not convertible when binding, an IniException is thrown.
+    *   @n Like subscriptions, bindings belong to the buffer object and are not copied with its content.
+    *
+    *   @param_t ValueT The type of the bound value. Supported are {int, float, bool}
+    */
+    template<typename ValueT>
+    BoundValue<ValueT> Bind(const std::string& section_name, const std::string& key_name);
+
+    /// Same as Bind for names given as C strings. If a name is a nullptr, an IniException is thrown.
+    template<typename ValueT>
+    BoundValue<ValueT> Bind(const char* section_name, const char* key_name);
+
+    /// Removes a subscription. Unknown identifiers are ignored.
+    void Unsubscribe(SubscriptionId subscription_id) noexcept;
+
+    /// Starts a batch of mutations. Batches can be nested. Notifications are delayed until the outermost batch ends.
+    void BeginBatch() noexcept;
+
+    /// Ends a batch of mutations and notifies the subscribers if it was the outermost batch. Throws an IniException if no batch was started.
+    void EndBatch();
+
+    /** Writes the changes since LoadFile or the last Save back to the loaded file.
+    *
+    *   @details
+    *   Sections are tracked as changed when a property is added, modified or erased. Unchanged sections are copied
+    *   @n verbatim from the file, with their comments and formatting, using copy_file_range or sendfile. Changed sections
+    *   @n are formatted like WriteFile does, keeping the comments in front of their header. New sections are appended.
+    *   @n If every changed section keeps its size, only its bytes are overwritten in place. Otherwise the new file is
+    *   @n written to <fullfilename>.tmp, which then replaces the file. On Windows the whole file is rewritten without header.
+    *   @n Changes are only tracked for a buffer which was empty when LoadFile loaded a file without include directives.
+    *   @n Other loads, Clear and merged content mark all sections as changed.
+    *   @n Throws an IniException if changes are not tracked or if the file was modified since it was loaded or saved.
+    */
+    void Save();
+
+    /// Checks if there are changes which are not saved by Save(). Always false if changes are not tracked.
+    bool IsDirty() const noexcept;
+
+    // End of public IniBuffer interface
+    //===================================================================================
+
+    private:
+
+    class Section
+    {
+        template<typename, typename> friend class BasicIniBuffer;
+        friend class IniStack;
+        friend class FrozenIni;
+
+        public:
+
+        /// Constructs a section which is a nested data structure of the IniBuffer.
+        Section() noexcept;
+
+        /// Constructs a named IniBuffer section.
+        Section(const std::string& section_name) noexcept;
+
+        Section(const Section&) = default;
+        Section(Section&&) = default;
+        Section& operator=(const Section&) = default;
+        Section& operator=(Section&&) = default;
+
+        ~Section() noexcept;
+
+        /** Get the value from a property (key value pair) in the section.
+        *
+        *   @details
+        *   If an error occurred during the operation an IniException is thrown.
+        *
+        *   @param_t ValueT Data type of the requested value.
+        *   @param key_name Key of he requested value.
+        */
+        template<typename ValueT>
+        ValueT GetValue(const std::string& key_name) const;
+
+        /// Same as GetValue<std::string> but returns a reference to the stored string instead of a copy.
+        const std::string& GetStringRef(const std::string& key_name) const;
+
+        /// Returns the name of this section.
+        const std::string& GetName() const noexcept;
+
+        /** Adds a new property [key | value pair] to the section.
+        *
+        *   @details
+        *   A new property is added or an existing one updated.
+        *
+        *   @param key Name of the key where the new value should be stored.
+        *   @param value The value which belongs to the key as string. (type is detected at insertion.)
+        */
+        void AddProperty(const std::string& key, const std::string& value) noexcept;
+
+        /// Deletes a key|vaue pair.
+        void EraseProperty(const std::string& key) noexcept;
+
+        /// Returns an estimate of the heap memory in bytes occupied by the properties of this section.
+        size_t GetMemoryUsage() const noexcept;
+
+        /// Writes this section to a sink. See internal::StringSink for the interface of a sink.
+        template<typename SinkT>
+        void WriteSection(SinkT& sink) const;
+
+        private:
+
+        /// Data type alias of a stored value. Used by the IniStack and the FrozenIni as well.
+        using StringifiedValue = IniBufferBase::StringifiedValue;
+
+        /// Data type alias for keys.
+        using KeyName_t = std::string;
+
+        /// Data type alias for the map of properties [Key | Value pairs].
+        using PropertyMap_t = typename StoragePolicyT::template Map_t<KeyName_t, StringifiedValue, AllocatorT>;
+
+        /// Name of this section.
+        std::string name_;
+
+        /// Actual place where the properties (key/value pairs) are stored.
+        PropertyMap_t properties_;
+    };
+
+    /** Inserting a new section to the IniBuffer.
+    *
+    *   @details
+    *   If already a section with the same name is present in the buffer, the old section will be overwritten.
+    */
+    void AddSection(const Section& section) noexcept;
+
+    /// Stores the events of an IniReader in a buffer and resolves include directives.
+    class Loader: public IniHandler
+    {
+        public:
+
+        /// Constructs a loader which stores the content of a file in the buffer.
+        Loader(BasicIniBuffer& buffer, const std::string& fullfilename, IncludeContext& context) noexcept;
+
+        void OnSection(const StringView& section_name, size_t line_nr) override;
+        void OnProperty(const StringView& key_name, const StringView& value, size_t line_nr) override;
+        void OnInclude(const StringView& path, size_t line_nr) override;
+
+        private:
+
+        /// Buffer where the content is stored.
+        BasicIniBuffer& buffer_;
+
+        /// File which is loaded. Used to resolve relative include paths. For content from memory or streams a path inside the base directory, or empty.
+        std::string fullfilename_;
+
+        /// Include chain and dependencies of the loaded file.
+        IncludeContext& context_;
+
+        /// Section to which read properties belong to. Avoids a lookup per property.
+        Section* current_section_;
+
+        /// Sections defined so far by this load, in the file or in included files.
+        std::set<std::string> defined_sections_;
+    };
+
+    /** Interprets all lines of an ini configuration file and stores its content in the buffer.
+    *
+    *   @details
+    *   Include directives are resolved recursively. The context collects the include chain and the dependencies of the content.
+    */
+    void ParseFile(const std::string& fullfilename, IncludeContext& context);
+
+    /// Adds the whole content of another buffer, which may use another storage. Existing properties are overwritten.
+    template<typename BufferT>
+    void MergeBuffer(const BufferT& buffer) noexcept;
+
+    /// Writes the header and all sections to a sink. See internal::StringSink for the interface of a sink.
+    template<typename SinkT>
+    void Serialize(SinkT& sink, const std::string& header) const;
+
+#if !defined(_WIN32)
+    /** Formats chunks of sections concurrently and writes each one at its offset of the file.
+    *
+    *   @return false if the content is smaller than parallel_write_min_size or fits into one chunk. Nothing is written in this case.
+    */
+    bool WriteFileParallel(const std::string& fullfilename, const std::string& header, size_t thread_count) const;
+#endif
+
+    /// Adds an empty section (without any properties) to the IniBuffer.
+    void AddEmptySection(const std::string& section_name) noexcept;
+
+    /// A registered callback with the observed property.
+    struct Subscription
+    {
+        SubscriptionId id;
+        std::string section_name;
+        std::string key_name;
+        Callback_t callback;
+    };
+
+    /// Subscriptions and the changes of the current batch. Stays with the buffer object when its content is copied or assigned.
+    struct Notifier
+    {
+        Notifier() = default;
+        Notifier(const Notifier&) noexcept {}
+        Notifier(Notifier&&) = default;
+        Notifier& operator=(const Notifier&) noexcept {return *this;}
+        Notifier& operator=(Notifier&&) noexcept {return *this;}
+
+        std::vector<Subscription> subscriptions;
+        std::vector<std::weak_ptr<BoundCellBase>> bindings;
+        std::set<std::pair<std::string, std::string>> pending_changes;
+        size_t batch_depth = 0;
+        SubscriptionId next_id = 0;
+    };
+
+    /// File loaded by LoadFile and the sections changed since then. Used by Save.
+    struct SavedFile
+    {
+        /// State of the file when it was loaded or saved. The fullfilename is empty if changes are not tracked.
+        internal::FileStamp stamp{std::string(), 0, 0, 0};
+
+        /// Names of sections with added, modified or erased properties and of erased sections.
+        std::set<std::string> dirty_sections;
+
+        /// Set if all sections are considered as changed, e.g. after Clear or merged content.
+        bool all_dirty = false;
+
+        /// Byte ranges of the sections in the file. Found at the first Save and updated by every Save.
+        std::vector<internal::SectionRange> ranges;
+        bool has_ranges = false;
+
+        /// Set if the file is empty or ends with a line break. Valid together with the ranges.
+        bool ends_with_line_break = true;
+    };
+
+    /// Access profile of the buffer object. Not copied with the content of the buffer.
+    struct Profiler
+    {
+        Profiler() = default;
+        Profiler(const Profiler&) noexcept {}
+        Profiler(Profiler&&) = default;
+        Profiler& operator=(const Profiler&) noexcept {return *this;}
+        Profiler& operator=(Profiler&&) noexcept {return *this;}
+
+        std::unique_ptr<internal::AccessProfile> profile;
+    };
+
+    /// Looks up a value like Find() and counts the lookup. Only called while access profiling is enabled.
+    const StringifiedValue* FindCounted(const std::string& section_name, const std::string& key_name) const;
+
+    /// Checks if anybody subscribed. Mutations only record changes in this case.
+    bool HasSubscribers() const noexcept;
+
+    /// Checks if a property is stored with exactly this value.
+    bool IsStored(const std::string& section_name, const std::string& key_name, const std::string& value) const noexcept;
+
+    /// Looks up a stored value. Returns nullptr if the property is not present.
+    const StringifiedValue* Find(const std::string& section_name, const std::string& key_name) const noexcept;
+
+    /// Records a changed property for the current batch.
+    void RecordChange(const std::string& section_name, const std::string& key_name);
+
+    /// Records all properties which differ between the previous and the current content.
+    void RecordChanges(const SectionMap_t& previous_sections);
+
+    /// Notifies the subscribers about the recorded changes unless a batch is running.
+    void NotifySubscribers();
+
+    /// Checks if changes are tracked for Save.
+    bool IsTracked() const noexcept;
+
+    /// Marks a section as changed if changes are tracked.
+    void MarkDirty(const std::string& section_name);
+
+    /// Marks all sections as changed if changes are tracked.
+    void MarkAllDirty() noexcept;
+
+#if !defined(_WIN32)
+    /// Writes the changed sections into the tracked file, in place or by splicing them with the unchanged ranges of the file.
+    void SaveChanges();
+#endif
+
+    /** Runs a load function as one batch.
+    *
+    *   @details
+    *   With subscribers, the content before loading is kept to report the differences afterwards.
+    */
+    template<typename LoadFunctionT>
+    void Load(LoadFunctionT load_function);
+
+    /// A Map of sections with their names [section_name | section_object]
+    SectionMap_t sections_;
+
+    /// Subscriptions to changes of the content.
+    Notifier notifier_;
+
+    /// Lookup counts. Only present while access profiling is enabled.
+    Profiler profiler_;
+
+    /// Tracked file and changed sections.
+    SavedFile saved_file_;
+};
+
+/// Buffer storing sections and properties in std::map with the standard allocator.
+using IniBuffer = BasicIniBuffer<OrderedStorage, std::allocator<char>>;
+
+//===================================================================================
+// IniCache class declaration
+
+/** Opt-in process-wide cache of parsed ini files.
+*   @n Buffers returned by the cache are immutable and shared by all callers requesting the same file.
+*   @n A cached buffer is reused as long as size, modification time and inode of the file and of all files included by it are unchanged.
+*   @n If the memory budget is exceeded, the least recently used buffers are evicted. Evicted buffers stay valid for their holders.
+*   @n The cache is thread safe. Include directives of LoadFile are resolved through this cache as well.
+*/
+class IniCache
+{
+    template<typename, typename> friend class BasicIniBuffer;
+
+    public:
+
+    /** Returns the parsed content of a file.
+    *
+    *   @details
+    *   The file is only parsed if it is not cached yet or was modified since.
+    *   @n If the file can not be parsed, an IniException is thrown.
+    *
+    *   @param fullfilename The path and filename pointing to the configuration file.
+    */
+    static std::shared_ptr<const IniBuffer> Get(const std::string& fullfilename);
+
+    /// Sets the memory budget in bytes. Least recently used buffers are evicted immediately if it is exceeded.
+    static void SetMemoryBudget(size_t bytes) noexcept;
+
+    /// Returns the estimated memory in bytes occupied by all cached buffers.
+    static size_t GetMemoryUsage() noexcept;
+
+    /// Removes all buffers from the cache.
+    static void Clear() noexcept;
+
+    private:
+
+    /// Default memory budget of the cache.
+    static constexpr size_t default_memory_budget = 256*1024*1024;
+
+    /// Data type alias for the usage order of the cached files. The most recently used file is in front.
+    using UsageList_t = std::list<std::string>;
+
+    /// Parsed file including everything needed to validate it.
+    struct Entry
+    {
+        std::vector<internal::FileStamp> dependencies;
+        std::shared_ptr<const IniBuffer> buffer;
+        size_t memory_usage;
+        UsageList_t::iterator usage;
+    };
+
+    /// Shared state of the process-wide cache.
+    struct State
+    {
+        std::mutex mutex;
+        std::map<std::string, Entry> entries;
+        UsageList_t usage;
+        size_t memory_usage = 0;
+        size_t memory_budget = default_memory_budget;
+    };
+
+    /// Returns the process-wide state.
+    static State& GetState() noexcept;
+
+    /** Returns the parsed content of a file and appends all its dependencies to the context.
+    *
+    *   @details
+    *   The include chain of the context is used to detect include cycles.
+    */
+    static std::shared_ptr<const IniBuffer> Get(const std::string& fullfilename, IniBuffer::IncludeContext& context);
+
+    /// Evicts least recently used buffers until the budget is met. The most recently used buffer is never evicted.
+    static void Evict(State& state) noexcept;
+};
+
+/// Namespace for internal functions which are used by the IniBuffer Class.
+namespace internal
+{
+    /** Finds the data type of a string.
+    *
+    *   @details
+    *   Used internally by the IniBuffer class.
+    */
+    IniBufferBase::DataType GetDataType(const std::string& str) noexcept;
+
+    /// Checks if a file still matches the recorded stamp.
+    bool IsUnchanged(const FileStamp& stamp) noexcept;
+
+    /// Returns the heap memory in bytes occupied by a string. Short strings stored inside the object occupy none.
+    size_t GetHeapSize(const std::string& str) noexcept;
+
+    /** Resolves the path of an included file.
+    *
+    *   @details
+    *   Relative paths are interpreted relative to the directory of the including file.
+    */
+    std::string ResolveIncludePath(const std::string& including_file, const std::string& included_file);
+
+    /// Returns a path which ResolveIncludePath treats like a file inside the given directory. Empty for the current working directory.
+    std::string GetIncludeBase(const std::string& base_directory);
+
+    /// Sink for serialized content, which appends to a std::string.
+    class StringSink
+    {
+        public:
+
+        explicit StringSink(std::string& output) noexcept : output_(output) {}
+
+        void Append(const char* data, size_t size) {output_.append(data, size);}
+        void Append(const std::string& str) {output_.append(str);}
+        void Append(char ch) {output_.push_back(ch);}
+
+        private:
+
+        std::string& output_;
+    };
+
+    /// Sink for serialized content, which only counts the number of characters.
+    class SizeSink
+    {
+        public:
+
+        void Append(const char*, size_t size) noexcept {size_ += size;}
+        void Append(const std::string& str) noexcept {size_ += str.size();}
+        void Append(char) noexcept {++size_;}
+
+        size_t GetSize() const noexcept {return size_;}
+
+        private:
+
+        size_t size_ = 0;
+    };
+
+    /// Sink for serialized content, which writes to a stream.
+    class StreamSink
+    {
+        public:
+
+        explicit StreamSink(std::ostream& stream) noexcept : stream_(stream) {}
+
+        void Append(const char* data, size_t size) {stream_.write(data, static_cast<std::streamsize>(size));}
+        void Append(const std::string& str) {Append(str.data(), str.size());}
+        void Append(char ch) {stream_.put(ch);}
+
+        private:
+
+        std::ostream& stream_;
+    };
+}
+
+/** Gets the current DateTime and returns it in a formatted line.
+* @details
+* Format is: YYYY/MM/DD hh:mm:ss
+*/
+static std::string GetDateTime() noexcept;
+
+
+//===================================================================================
+// Implementation
+
+//-----------------------------------------------------------------------------------
+// IniException
+
+IniException::IniException(const int line, const std::string& message)
+{
+    message_ = "[IniBufferException][File: " + std::string(__FILE__)+"][Line: " + std::to_string(line) + "][What: " + message + "]\n";
+}
+
+const char* IniException::what() const throw()
+{
+    return message_.c_str();
+}
+
+
+//-----------------------------------------------------------------------------------
+// IniHandler
+
+IniHandler::~IniHandler() noexcept
+{}
+
+void IniHandler::OnSection(const StringView&, size_t)
+{}
+
+void IniHandler::OnProperty(const StringView&, const StringView&, size_t)
+{}
+
+void IniHandler::OnComment(const StringView&, size_t)
+{}
+
+void IniHandler::OnInclude(const StringView&, size_t)
+{}
+
+//-----------------------------------------------------------------------------------
+// IniReader
+
+constexpr size_t IniReader::chunk_size;
+
+IniReader::IniReader(IniHandler& handler) noexcept
+: handler_(handler),
+  line_nr_(0),
+  input_offset_(0),
+  partial_line_offset_(0),
+  line_offset_(0),
+  line_end_offset_(0),
+  has_section_(false),
+  ends_with_line_break_(true)
+{}
+
+void IniReader::ReadFile(const std::string& fullfilename)
+{
+    std::ifstream fstrm(fullfilename, std::ios::in | std::ios::binary);
+    if(!fstrm.is_open())
+    {
+        throw INI_EXCEPTION("Opening file failed: " + fullfilename);
+    }
+
+    ReadStream(fstrm);
+    LOG("Reached end of ini file.");
+}
+
+void IniReader::ReadStream(std::istream& stream)
+{
+    std::streambuf* stream_buffer = stream.rdbuf();
+    if(stream_buffer == nullptr || !stream.good())
+    {
+        throw INI_EXCEPTION("Stream is not readable.");
+    }
+
+    std::unique_ptr<char[]> chunk(new char[chunk_size]);
+    while(true)
+    {
+        std::streamsize size = stream_buffer->sgetn(chunk.get(), chunk_size);
+        if(size <= 0)
+        {
+            break;
+        }
+        Read(chunk.get(), static_cast<size_t>(size));
+    }
+    stream.setstate(std::ios::eofbit);
+    Finish();
+}
+
+void IniReader::Read(const char* data, size_t size)
+{
+    StringView input(data, size);
+    const size_t chunk_offset = input_offset_;
+    if(size > 0)
+    {
+        ends_with_line_break_ = data[size - 1] == '\n';
+    }
+    input_offset_ += size;
+
+    if(!partial_line_.empty())
+    {
+        size_t line_end = input.find('\n');
+        if(line_end == StringView::npos)
+        {
+            partial_line_.append(data, size);
+            return;
+        }
+
+        partial_line_.append(data, line_end);
+        line_offset_ = partial_line_offset_;
+        line_end_offset_ = chunk_offset + line_end + 1;
+        ReadLine(StringView(partial_line_));
+        partial_line_.clear();
+        input = input.substr(line_end + 1);
+    }
+
+    while(!input.empty())
+    {
+        size_t line_end = input.find('\n');
+        if(line_end == StringView::npos)
+        {
+            partial_line_offset_ = chunk_offset + static_cast<size_t>(input.data() - data);
+            partial_line_.assign(input.data(), input.size());
+            return;
+        }
+
+        line_offset_ = chunk_offset + static_cast<size_t>(input.data() - data);
+        line_end_offset_ = line_offset_ + line_end + 1;
+        ReadLine(input.substr(0, line_end));
+        input = input.substr(line_end + 1);
+    }
+}
+
+void IniReader::Finish()
+{
+    if(!partial_line_.empty())
+    {
+        line_offset_ = partial_line_offset_;
+        line_end_offset_ = partial_line_offset_ + partial_line_.size();
+        ReadLine(StringView(partial_line_));
+        partial_line_.clear();
+    }
+    if(input_offset_ == 0)
+    {
+        ends_with_line_break_ = true;
+    }
+    line_nr_ = 0;
+    input_offset_ = 0;
+    has_section_ = false;
+}
+
+size_t IniReader::GetLineOffset() const noexcept
+{
+    return line_offset_;
+}
+
+size_t IniReader::GetLineEndOffset() const noexcept
+{
+    return line_end_offset_;
+}
+
+bool IniReader::EndsWithLineBreak() const noexcept
+{
+    return ends_with_line_break_;
+}
+
+void IniReader::ReadLine(StringView line)
+{
+    ++line_nr_;
+
+    // Comment
+    StringView comment;
+    bool has_comment = false;
+    size_t pos = line.find_first_of(";#");
+    if(pos != StringView::npos)
+    {
+        comment = line.substr(pos + 1);
+        TrimWhitespace(comment);
+        has_comment = true;
+        line = line.substr(0, pos);
+    }
+
+    TrimWhitespace(line);
+
+    // Empty line
+    if(line.empty())
+    {
+        // nothing to do
+    }
+
+    // Include directive: !include <path>
+    else if(line[0] == '!')
+    {
+        if(!line.starts_with("!include") || line.size() <= 8 || !std::isspace(static_cast<unsigned char>(line[8])))
+        {
+            throw INI_EXCEPTION("Invalid ini-file. Unknown directive. Line: " + std::to_string(line_nr_));
+        }
+
+        StringView path = line.substr(8);
+        TrimWhitespace(path);
+        handler_.OnInclude(path, line_nr_);
+    }
+
+    // Section
+    else if(line[0] == '[')
+    {
+        pos = line.find(']');
+        if(pos == StringView::npos)
+        {
+            throw INI_EXCEPTION("Ivalid ini-file ] is missing in section. Line: " + std::to_string(line_nr_));
+        }
+
+        StringView section_name = line.substr(1, pos - 1);
+        TrimWhitespace(section_name);
+        has_section_ = true;
+        handler_.OnSection(section_name, line_nr_);
+    }
+
+    // Property
+    else if((pos = line.find('=')) != StringView::npos)
+    {
+        if(!has_section_)
+        {
+            throw INI_EXCEPTION("Invalid ini-file. Property must belong to a section. Line: " + std::to_string(line_nr_));
+        }
+
+        StringView key_name = line.substr(0, pos);
+        StringView value = line.substr(pos + 1);
+        TrimWhitespace(key_name);
+        TrimWhitespace(value);
+
+        if(ContainsWhiteSpace(key_name))
+        {
+            throw INI_EXCEPTION("Invalid ini-file. Key contains white spaces: " + std::to_string(line_nr_));
+        }
+        handler_.OnProperty(key_name, value, line_nr_);
+    }
+    else
+    {
+        throw INI_EXCEPTION("Invalid ini-file. Line is not a valid ini-file component: " + std::to_string(line_nr_));
+    }
+
+    if(has_comment)
+    {
+        handler_.OnComment(comment, line_nr_);
+    }
+}
+
+//-----------------------------------------------------------------------------------
+// Stringified Value
+
+IniBufferBase::StringifiedValue::StringifiedValue() noexcept
+: type_(DataType::EMPTY),
+  read_count_(0),
+  value_("")
+{}
+
+IniBufferBase::StringifiedValue::StringifiedValue(const std::string& value) noexcept
+: read_count_(0)
+{
+    type_ = internal::GetDataType(value);
+    value_ = value;
+}
+
+IniBufferBase::StringifiedValue::StringifiedValue(const StringifiedValue& other)
+: type_(other.type_),
+  read_count_(other.GetReadCount()),
+  value_(other.value_)
+{}
+
+IniBufferBase::StringifiedValue::StringifiedValue(StringifiedValue&& other) noexcept
+: type_(other.type_),
+  read_count_(other.GetReadCount()),
+  value_(std::move(other.value_))
+{}
+
+IniBufferBase::StringifiedValue& IniBufferBase::StringifiedValue::operator=(const StringifiedValue& other)
+{
+    type_ = other.type_;
+    read_count_.store(other.GetReadCount(), std::memory_order_relaxed);
+    value_ = other.value_;
+    return *this;
+}
+
+IniBufferBase::StringifiedValue& IniBufferBase::StringifiedValue::operator=(StringifiedValue&& other) noexcept
+{
+    type_ = other.type_;
+    read_count_.store(other.GetReadCount(), std::memory_order_relaxed);
+    value_ = std::move(other.value_);
+    return *this;
+}
+
+void IniBufferBase::StringifiedValue::SetValue(const std::string& value)
+{
+    type_ = internal::GetDataType(value);
+    value_ = value;
+}
+
+void IniBufferBase::StringifiedValue::CountRead() const noexcept
+{
+    // The margin below the maximum absorbs increments of threads which passed the check at the same time.
+    if(read_count_.load(std::memory_order_relaxed) < std::numeric_limits<uint32_t>::max() - 256)
+    {
+        read_count_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+uint32_t IniBufferBase::StringifiedValue::GetReadCount() const noexcept
+{
+    return read_count_.load(std::memory_order_relaxed);
+}
+
+void IniBufferBase::StringifiedValue::ResetReadCount() noexcept
+{
+    read_count_.store(0, std::memory_order_relaxed);
+}
+
+template<typename ValueT>
+ValueT IniBufferBase::StringifiedValue::GetValue() const
+{
+    try
+    {
+        return CastValue<ValueT>();
+    }
+    catch(const std::logic_error& e)
+    {
+        throw INI_EXCEPTION("Bad Cast: " + std::string(e.what()));
+    }
+    catch(...){throw;}
+}
+
+const std::string&  IniBufferBase::StringifiedValue::GetValueAsString() const noexcept
+{
+    return value_;
+}
+
+IniBufferBase::DataType IniBufferBase::StringifiedValue::GetType() const noexcept
+{
+    return type_;
+}
+
+const std::string& IniBufferBase::StringifiedValue::GetStringRef() const
+{
+    if(type_ == DataType::STRING)
+    {
+        return value_;
+    }
+    else
+    {
+        throw INI_EXCEPTION("Stored value is not a std::string.");
+    }
+}
+
+template<>
+std::string IniBufferBase::StringifiedValue::CastValue<std::string>() const
+{
+    if(type_ == DataType::STRING)
+    {
+        return value_;
+    }
+    else
+    {
+        throw INI_EXCEPTION("Stored value is not a std::string.");
+    }
+}
+
+template<>
+int IniBufferBase::StringifiedValue::CastValue<int>() const
+{
+    try
+    {
+        if(type_ == DataType::INT)
+        {
+            return std::stoi(value_);
+        }
+        else
+        {
+            throw INI_EXCEPTION("Stored value is not an int.");
+        }
+    }
+    catch(const std::invalid_argument& e){throw INI_EXCEPTION("Invalid Argument: " + std::string(e.what()));}
+    catch(const std::out_of_range& e){throw INI_EXCEPTION("Out Of Range: " + std::string(e.what()));}
+    catch(const IniException& e){throw;}
+    catch(const std::exception& e){throw INI_EXCEPTION( std::string(e.what()));}
+    catch(...){throw;}
+}
+
+template<>
+float IniBufferBase::StringifiedValue::CastValue<float>() const
+{
+    try
+    {
+        if(type_ == DataType::FLOAT)
+        {
+            return std::stof(value_);
+        }
+        else
+        {
+            throw INI_EXCEPTION("Stored value is not a float.");
+        }
+    }
+    catch(const std::invalid_argument& e){throw INI_EXCEPTION("Invalid Argument: " + std::string(e.what()));}
+    catch(const std::out_of_range& e){throw INI_EXCEPTION("Out Of Range: " + std::string(e.what()));}
+    catch(const IniException& e){throw;}
+    catch(const std::exception& e){throw INI_EXCEPTION( std::string(e.what()));}
+    catch(...){throw;}
+}
+
+template<>
+bool IniBufferBase::StringifiedValue::CastValue<bool>() const
+{
+    try
+    {
+        if(type_ == DataType::BOOL)
+        {
+            if(0 == value_.compare("true") ||
+               0 == value_.compare("TRUE") ||
+               0 == value_.compare("True"))
+            {
+                return true;
+            }
+            else
+            {
+                return false;
+            }
+        }
+        else
+        {
+            throw INI_EXCEPTION("Stored value is not a boolean.");
+        }
+    }
+    catch(const std::out_of_range& e){throw INI_EXCEPTION("Out Of Range: " + std::string(e.what()));}
+    catch(const IniException& e){throw;}
+    catch(const std::exception& e){throw INI_EXCEPTION( std::string(e.what()));}
+    catch(...){throw;}
+}
+
+template<typename ValueT>
+ValueT IniBufferBase::StringifiedValue::CastValue() const
+{
+     throw INI_EXCEPTION("Stored value is not supported for typecasting.");
+}
+
+
+IniBufferBase::StringifiedValue::~StringifiedValue() noexcept
+{
+    value_ = "";
+    type_ = DataType::EMPTY;
+}
+
+//-----------------------------------------------------------------------------------
+// Section
+template<typename StoragePolicyT, typename AllocatorT>
+BasicIniBuffer<StoragePolicyT, AllocatorT>::Section::Section() noexcept
+: name_("")
+{
+    properties_.clear();
+}
+
+template<typename StoragePolicyT, typename AllocatorT>
+BasicIniBuffer<StoragePolicyT, AllocatorT>::Section::Section(const std::string& name) noexcept
+: name_(name)
+{
+    properties_.clear();
+}
+
+template<typename StoragePolicyT, typename AllocatorT>
+const std::string& BasicIniBuffer<StoragePolicyT, AllocatorT>::Section::GetName() const noexcept
+{
+    return name_;
+}
+
+template<typename StoragePolicyT, typename AllocatorT>
+template<typename ValueT>
+ValueT BasicIniBuffer<StoragePolicyT, AllocatorT>::Section::GetValue(const std::string& key_name) const
+{
+    auto property = properties_.find(key_name);
+    if(property != properties_.end())
+    {
+        return property->second.template GetValue<ValueT>();
+    }
+    else
+    {
+        throw INI_EXCEPTION("Requested key_name is not present in the data structure: " + key_name);
+    }
+}
+
+template<typename StoragePolicyT, typename AllocatorT>
+const std::string& BasicIniBuffer<StoragePolicyT, AllocatorT>::Section::GetStringRef(const std::string& key_name) const
+{
+    auto property = properties_.find(key_name);
+    if(property != properties_.end())
+    {
+        return property->second.GetStringRef();
+    }
+    else
+    {
+        throw INI_EXCEPTION("Requested key_name is not present in the data structure: " + key_name);
+    }
+}
+
+template<typename StoragePolicyT, typename AllocatorT>
+void BasicIniBuffer<StoragePolicyT, AllocatorT>::Section::AddProperty(const std::string& key, const std::string& value) noexcept
+{
+    // Adds a new property or overwrites an existing one.
+    properties_[key].SetValue(value);
+}
+
+template<typename StoragePolicyT, typename AllocatorT>
+void BasicIniBuffer<StoragePolicyT, AllocatorT>::Section::EraseProperty(const std::string& key) noexcept
+{
+    properties_.erase(key);
+}
+
+template<typename StoragePolicyT, typename AllocatorT>
+size_t BasicIniBuffer<StoragePolicyT, AllocatorT>::Section::GetMemoryUsage() const noexcept
+{
+    size_t memory_usage = internal::GetHeapSize(name_);
+    for(const auto& property : properties_)
+    {
+        memory_usage += StoragePolicyT::node_overhead + sizeof(property);
+        memory_usage += internal::GetHeapSize(property.first) + internal::GetHeapSize(property.second.GetValueAsString());
+    }
+    return memory_usage;
+}
+
+template<typename StoragePolicyT, typename AllocatorT>
+template<typename SinkT>
+void BasicIniBuffer<StoragePolicyT, AllocatorT>::Section::WriteSection(SinkT& sink) const
+{
+    try
+    {
+        sink.Append('[');
+        sink.Append(name_);
+        sink.Append("]\n", 2);
+        for(const auto& item : properties_)
+        {
+            sink.Append(item.first);
+            sink.Append(" = ", 3);
+            sink.Append(item.second.GetValueAsString());
+            sink.Append('\n');
+        }
+        sink.Append('\n');
+    }
+    catch(std::ios_base::failure& e){throw INI_EXCEPTION("Error writing sections to file. Section Name:"+ name_ +"; Message: "+ std::string(e.what()));}
+    catch(...){throw;}
+}
+
+template<typename StoragePolicyT, typename AllocatorT>
+BasicIniBuffer<StoragePolicyT, AllocatorT>::Section::~Section() noexcept
+{
+    properties_.clear();
+}
+
+//-----------------------------------------------------------------------------------
+// IniBuffer
+
+template<typename StoragePolicyT, typename AllocatorT>
+void BasicIniBuffer<StoragePolicyT, AllocatorT>::LoadFile(const std::string& fullfilename)
+{
+    try
+    {
+        // Changes are tracked for Save if the buffer holds exactly the content of this file.
+        const bool is_tracked = sections_.empty();
+        bool has_includes = true;
+        internal::FileStamp stamp{fullfilename, 0, 0, 0};
+        Load([&]()
+        {
+            IncludeContext context;
+            ParseFile(fullfilename, context);
+            has_includes = context.dependencies.size() > 1;
+            stamp = context.dependencies.front();
+        });
+        if(is_tracked)
+        {
+            saved_file_ = SavedFile();
+            if(!has_includes)
+            {
+                saved_file_.stamp = stamp;
+            }
+        }
+    }
+    catch(IniException& e) {throw;}
+    catch(std::exception& e){throw INI_EXCEPTION( e.what());}
+    catch(...){throw;}
+}
+
+template<typename StoragePolicyT, typename AllocatorT>
+void BasicIniBuffer<StoragePolicyT, AllocatorT>::LoadFromBuffer(const char* data, size_t size, const std::string& base_directory)
+{
+    try
+    {
+        Load([&]()
+        {
+            IncludeContext context;
+            Loader loader(*this, internal::GetIncludeBase(base_directory), context);
+            IniReader reader(loader);
+            reader.Read(data, size);
+            reader.Finish();
+        });
+    }
+    catch(IniException& e) {throw;}
+    catch(std::exception& e){throw INI_EXCEPTION( e.what());}
+    catch(...){throw;}
+}
+
+template<typename StoragePolicyT, typename AllocatorT>
+void BasicIniBuffer<StoragePolicyT, AllocatorT>::LoadFromString(const std::string& content, const std::string& base_directory)
+{
+    LoadFromBuffer(content.data(), content.size(), base_directory);
+}
+
+template<typename StoragePolicyT, typename AllocatorT>
+void BasicIniBuffer<StoragePolicyT, AllocatorT>::LoadFromStream(std::istream& stream, const std::string& base_directory)
+{
+    try
+    {
+        Load([&]()
+        {
+            IncludeContext context;
+            Loader loader(*this, internal::GetIncludeBase(base_directory), context);
+            IniReader reader(loader);
+            reader.ReadStream(stream);
+        });
+    }
+    catch(IniException& e) {throw;}
+    catch(std::exception& e){throw INI_EXCEPTION( e.what());}
+    catch(...){throw;}
+}
+
+template<typename StoragePolicyT, typename AllocatorT>
+void BasicIniBuffer<StoragePolicyT, AllocatorT>::Adopt(BasicIniBuffer&& loaded)
+{
+    try
+    {
+        const bool is_tracked = sections_.empty();
+        Load([&]()
+        {
+            if(sections_.empty())
+            {
+                sections_.swap(loaded.sections_);
+                return;
+            }
+            for(auto& section : loaded.sections_)
+            {
+                sections_[section.first] = std::move(section.second);
+            }
+            loaded.sections_.clear();
+        });
+        if(is_tracked)
+        {
+            saved_file_ = std::move(loaded.saved_file_);
+        }
+        loaded.saved_file_ = SavedFile();
+    }
+    catch(IniException& e) {throw;}
+    catch(std::exception& e){throw INI_EXCEPTION( e.what());}
+    catch(...){throw;}
+}
+
+template<typename StoragePolicyT, typename AllocatorT>
+void BasicIniBuffer<StoragePolicyT, AllocatorT>::WriteFile(const std::string& fullfilename, bool with_header, size_t thread_count) const
+{
+    // The header is created before any thread starts, so formatting threads never read the local time.
+    const std::string header = CreateHeader(with_header);
+
+#if !defined(_WIN32)
+    if(thread_count == 0)
+    {
+        thread_count = std::thread::hardware_concurrency();
+    }
+    if(thread_count > 1)
+    {
+        try
+        {
+            if(WriteFileParallel(fullfilename, header, thread_count))
+            {
+                LOG("Wrote ini-file to disk: "+fullfilename);
+                return;
+            }
+        }
+        catch(IniException& e){throw;}
+        catch(std::exception& e){throw INI_EXCEPTION(e.what());}
+        catch(...){throw;}
+    }
+#else
+    (void)thread_count;
+#endif
+
+    std::ofstream file;
+    file.exceptions(std::ofstream::failbit);
+    try
+    {
+        file.open (fullfilename, std::ios::out | std::ios::trunc);
+    }
+    catch(std::ios_base::failure& e){throw INI_EXCEPTION("Can not open file. Maybe fullfilename is invalid. Filename: "+fullfilename);}
+    try
+    {
+        internal::StreamSink sink(file);
+        Serialize(sink, header);
+
+        file.close();
+        LOG("Wrote ini-file to disk: "+fullfilename);
+    }
+    catch(std::ios_base::failure& e){throw INI_EXCEPTION("Error writing header to file: " + std::string(e.what()));}
+    catch(IniException& e){throw;}
+    catch(std::exception& e){throw INI_EXCEPTION(e.what());}
+    catch(...){throw;}
+}
+
+#if !defined(_WIN32)
+template<typename StoragePolicyT, typename AllocatorT>
+bool BasicIniBuffer<StoragePolicyT, AllocatorT>::WriteFileParallel(const std::string& fullfilename, const std::string& header, size_t thread_count) const
+{
+    // Splits the sections into chunks of about write_chunk_size bytes. The offset of every chunk is known before formatting.
+    struct Chunk
+    {
+        std::vector<const Section*> sections;
+        size_t offset;
+        size_t size;
+    };
+    std::vector<Chunk> chunks;
+    size_t offset = header.size();
+    for(const auto& item : sections_)
+    {
+        internal::SizeSink size_sink;
+        item.second.WriteSection(size_sink);
+        if(chunks.empty() || chunks.back().size >= write_chunk_size)
+        {
+            chunks.push_back(Chunk{std::vector<const Section*>(), offset, 0});
+        }
+        chunks.back().sections.push_back(&item.second);
+        chunks.back().size += size_sink.GetSize();
+        offset += size_sink.GetSize();
+    }
+    if(chunks.size() < 2 || offset - header.size() < parallel_write_min_size)
+    {
+        return false;
+    }
+    thread_count = std::min(thread_count, chunks.size());
+
+    const int file_descriptor = open(fullfilename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if(file_descriptor < 0)
+    {
+        throw INI_EXCEPTION("Can not open file. Maybe fullfilename is invalid. Filename: "+fullfilename);
+    }
+    if(!internal::WriteAt(file_descriptor, header.data(), header.size(), 0))
+    {
+        close(file_descriptor);
+        throw INI_EXCEPTION("Error writing header to file: " + fullfilename);
+    }
+
+    // Every thread takes the next chunk, formats it into its own buffer and writes it at its offset.
+    std::atomic<size_t> next_chunk(0);
+    std::atomic<bool> failed(false);
+    std::vector<std::exception_ptr> errors(thread_count);
+    auto write_chunks = [&](size_t thread_index)
+    {
+        try
+        {
+            std::string buffer;
+            for(size_t i = next_chunk++; i < chunks.size() && !failed; i = next_chunk++)
+            {
+                buffer.clear();
+                buffer.reserve(chunks[i].size);
+                internal::StringSink sink(buffer);
+                for(const Section* section : chunks[i].sections)
+                {
+                    section->WriteSection(sink);
+                }
+                if(!internal::WriteAt(file_descriptor, buffer.data(), buffer.size(), chunks[i].offset))
+                {
+                    throw INI_EXCEPTION("Error writing to file: " + fullfilename + "; " + std::strerror(errno));
+                }
+            }
+        }
+        catch(...)
+        {
+            failed = true;
+            errors[thread_index] = std::current_exception();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    try
+    {
+        for(size_t i = 1; i < thread_count; ++i)
+        {
+            threads.emplace_back(write_chunks, i);
+        }
+    }
+    catch(std::system_error&)
+    {
+        // The chunks are shared by the threads which could be started.
+    }
+    write_chunks(0);
+    for(std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    const bool closed = close(file_descriptor) == 0;
+    for(const std::exception_ptr& error : errors)
+    {
+        if(error != nullptr)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+    if(!closed)
+    {
+        throw INI_EXCEPTION("Error writing to file: " + fullfilename);
+    }
+    return true;
+}
+#endif
+
+template<typename StoragePolicyT, typename AllocatorT>
+std::string BasicIniBuffer<StoragePolicyT, AllocatorT>::WriteToString(bool with_header) const
+{
+    std::string output;
+    WriteToBuffer(output, with_header);
+    return output;
+}
+
+template<typename StoragePolicyT, typename AllocatorT>
+void BasicIniBuffer<StoragePolicyT, AllocatorT>::WriteToBuffer(std::string& buffer, bool with_header) const
+{
+    try
+    {
+        const std::string header = CreateHeader(with_header);
+
+        internal::SizeSink size_sink;
+        Serialize(size_sink, header);
+
+        buffer.clear();
+        buffer.reserve(size_sink.GetSize());
+        internal::StringSink sink(buffer);
+        Serialize(sink, header);
+    }
+    catch(IniException& e){throw;}
+    catch(std::exception& e){throw INI_EXCEPTION(e.what());}
+    catch(...){throw;}
+}
+
+template<typename StoragePolicyT, typename AllocatorT>
+void BasicIniBuffer<StoragePolicyT, AllocatorT>::WriteToStream(std::ostream& stream, bool with_header) const
+{
+    try
+    {
+        internal::StreamSink sink(stream);
+        Serialize(sink, CreateHeader(with_header));
+    }
+    catch(std::ios_base::failure& e){throw INI_EXCEPTION("Error writing to stream: " + std::string(e.what()));}
+    catch(IniException& e){throw;}
+    catch(std::exception& e){throw INI_EXCEPTION(e.what());}
+    catch(...){throw;}
+
+    if(!stream.good())
+    {
+        throw INI_EXCEPTION("Error writing to stream.");
+    }
+}
+
+std::string IniBufferBase::CreateHeader(bool with_header)
+{
+    if(!with_header)
+    {
+        return std::string();
+    }
+    return "# Configuration File\n# " + GetDateTime() + "\n\n";
+}
+
+template<typename StoragePolicyT, typename AllocatorT>
+template<typename SinkT>
+void BasicIniBuffer<StoragePolicyT, AllocatorT>::Serialize(SinkT& sink, const std::string& header) const
+{
+    sink.Append(header);
+    for(const auto& item : sections_)
+    {
+        item.second.WriteSection(sink);
+    }
+}
+
+template<typename StoragePolicyT, typename AllocatorT>
+void BasicIniBuffer<StoragePolicyT, AllocatorT>::Clear()
+{
+    if(HasSubscribers())
+    {
+        for(const auto& section : sections_)
+        {
+            for(const auto& property : section.second.properties_)
+            {
+                RecordChange(section.first, property.first);
+            }
+        }
+    }
+    sections_.clear();
+    MarkAllDirty();
+    LOG("Cleared IniBuffer.");
+    NotifySubscribers();
+}
+
+template<typename StoragePolicyT, typename AllocatorT>
+void BasicIniBuffer<StoragePolicyT, AllocatorT>::EnableAccessProfiling()
+{
+    for(auto& section : sections_)
+    {
+        for(auto& property : section.second.properties_)
+        {
+            property.second.ResetReadCount();
+        }
+    }
+    profiler_.profile.reset(new internal::AccessProfile());
+}
+
+template<typename StoragePolicyT, typename AllocatorT>
+void BasicIniBuffer<StoragePolicyT, AllocatorT>::DisableAccessProfiling() noexcept
+{
+    profiler_.profile.reset();
+}
+
+template<typename StoragePolicyT, typename AllocatorT>
+IniBufferBase::AccessReport BasicIniBuffer<StoragePolicyT, AllocatorT>::GetAccessReport() const
+{
+    if(profiler_.profile == nullptr)
+    {
+        throw INI_EXCEPTION("Access profiling is not enabled.");
+    }
+
+    internal::AccessProfile::Counts_t misses;
+    profiler_.profile->Collect(misses);
+
+    AccessReport report;
+    for(const auto& section : misses)
+    {
+        for(const auto& key : section.second)
+        {
+            report.missing_keys.push_back(AccessCount{section.first, key.first, key.second});
+        }
+    }
+    for(const auto& section : sections_)
+    {
+        for(const auto& property : section.second.properties_)
+        {
+            const uint64_t count = property.second.GetReadCount();
+            (count != 0 ? report.hot_keys : report.unread_keys).push_back(AccessCount{section.first, property.first, count});
+        }
+    }
+
+    auto by_count = [](const AccessCount& a, const AccessCount& b){return a.count > b.count;};
+    std::stable_sort(report.hot_keys.begin(), report.hot_keys.end(), by_count);
+    std::stable_sort(report.missing_keys.begin(), report.missing_keys.end(), by_count);
+    return report;
+}
+
+template<typename StoragePolicyT, typename AllocatorT>
+void BasicIniBuffer<StoragePolicyT, AllocatorT>::WriteAccessReport(std::ostream& stream, size_t max_hot_keys) const
+{
+    const AccessReport report = GetAccessReport();
+
+    stream<<"Hot keys ("<<std::min(max_hot_keys, report.hot_keys.size())<<" of "<<report.hot_keys.size()<<" read keys):\n";
+    for(size_t i = 0; i < report.hot_keys.size() && i < max_hot_keys; ++i)
+    {
+        stream<<"  "<<report.hot_keys[i].count<<"  ["<<report.hot_keys[i].section_name<<"] "<<report.hot_keys[i].key_name<<'\n';
+    }
+
+    stream<<"Never read keys ("<<report.unread_keys.size()<<"):\n";
+    for(const AccessCount& key : report.unread_keys)
+    {
+        stream<<"  ["<<key.section_name<<"] "<<key.key_name<<'\n';
+    }
+
+    stream<<"Missing keys ("<<report.missing_keys.size()<<"):\n";
+    for(const AccessCount& key : report.missing_keys)
+    {
+        stream<<"  "<<key.count<<"  ["<<key.section_name<<"] "<<key.key_name<<'\n';
+    }
+
+    if(!stream)
+    {
+        throw INI_EXCEPTION("Error writing access report.");
+    }
+}
+
+template<typename StoragePolicyT, typename AllocatorT>
+const IniBufferBase::StringifiedValue* BasicIniBuffer<StoragePolicyT, AllocatorT>::FindCounted(const std::string& section_name, const std::string& key_name) const
+{
+    const StringifiedValue* value = Find(section_name, key_name);
+    if(value != nullptr)
+    {
+        value->CountRead();
+    }
+    else
+    {
+        profiler_.profile->RecordMiss(section_name, key_name);
+    }
+    return value;
+}
+
+template<typename StoragePolicyT, typename AllocatorT>
+size_t BasicIniBuffer<StoragePolicyT, AllocatorT>::GetMemoryUsage() const noexcept
+{
+    size_t memory_usage = 0;
+    for(const auto& section : sections_)
+    {
+        memory_usage += StoragePolicyT::node_overhead + sizeof(section);
+        memory_usage += internal::GetHeapSize(section.first) + section.second.GetMemoryUsage();
+    }
+    return memory_usage;
+}
+
+template<typename StoragePolicyT, typename AllocatorT>
+template<typename ValueT>
+ValueT BasicIniBuffer<StoragePolicyT, AllocatorT>::GetValue(const std::string& section_name, const std::string& key_name) const
+{
+    if(profiler_.profile != nullptr)
+    {
+        const StringifiedValue* value = FindCounted(section_name, key_name);
+        if(value != nullptr)
+        {
+            return value->template GetValue<ValueT>();
+        }
+    }
+
+    auto section = sections_.find(section_name);
+    if(section != sections_.end())
+    {
+        return section->second.template GetValue<ValueT>(key_name);
+    }
+    else
+    {
+        throw INI_EXCEPTION("Requested Section Name is not present in the data structure. Requested Name: " + section_name);
+    }
+}
+
+template<typename StoragePolicyT, typename AllocatorT>
+template<typename ValueT>
+ValueT BasicIniBuffer<StoragePolicyT, AllocatorT>::GetValue(const char* section_name, const char* key_name) const
+{
+    if(section_name == nullptr || key_name == nullptr)
+    {
+        throw INI_EXCEPTION("Requested section or key name is a nullptr.");
+    }
+    return GetValue<ValueT>(section_name, std::strlen(section_name), key_name, std::strlen(key_name));
+}
+
+template<typename StoragePolicyT, typename AllocatorT>
+template<typename ValueT>
+ValueT BasicIniBuffer<StoragePolicyT, AllocatorT>::GetValue(const char* section_name, size_t section_name_length, const char* key_name, size_t key_name_length) const
+{
+    internal::LookupKeysScope scope;
+    AssignLookupKeys(scope.keys, section_name, section_name_length, key_name, key_name_length);
+    return GetValue<ValueT>(scope.keys.section_name, scope.keys.key_name);
+}
+
+template<typename StoragePolicyT, typename AllocatorT>
+const std::string& BasicIniBuffer<StoragePolicyT, AllocatorT>::GetStringRef(const char* section_name, const char* key_name) const
+{
+    if(section_name == nullptr || key_name == nullptr)
+    {
+        throw INI_EXCEPTION("Requested section or key name is a nullptr.");
+    }
+    return GetStringRef(section_name, std::strlen(section_name), key_name, std::strlen(key_name));
+}
+
+template<typename StoragePolicyT, typename AllocatorT>
+const std::string& BasicIniBuffer<StoragePolicyT, AllocatorT>::GetStringRef(const char* section_name, size_t section_name_length, const char* key_name, size_t key_name_length) const
+{
+    internal::LookupKeysScope scope;
+    AssignLookupKeys(scope.keys, section_name, section_name_length, key_name, key_name_length);
+    return GetStringRef(scope.keys.section_name, scope.keys.key_name);
+}
+
+void IniBufferBase::AssignLookupKeys(internal::LookupKeys& keys, const char* section_name, size_t section_name_length, const char* key_name, size_t key_name_length)
+{
+    if(section_name == nullptr || key_name == nullptr)
+    {
+        throw INI_EXCEPTION("Requested section or key name is a nullptr.");
+    }
+    keys.section_name.assign(section_name, section_name_length);
+    keys.key_name.assign(key_name, key_name_length);
+}
+
+template<typename StoragePolicyT, typename AllocatorT>
+const std::string& BasicIniBuffer<StoragePolicyT, AllocatorT>::GetStringRef(const std::string& section_name, const std::string& key_name) const
+{
+    if(profiler_.profile != nullptr)
+    {
+        const StringifiedValue* value = FindCounted(section_name, key_name);
+        if(value != nullptr)
+        {
+            return value->GetStringRef();
+        }
+    }
+
+    auto section = sections_.find(section_name);
+    if(section != sections_.end())
+    {
+        return section->second.GetStringRef(key_name);
+    }
+    else
+    {
+        throw INI_EXCEPTION("Requested Section Name is not present in the data structure. Requested Name: " + section_name);
+    }
+}
+
+template<typename StoragePolicyT, typename AllocatorT>
+const std::string* BasicIniBuffer<StoragePolicyT, AllocatorT>::FindStoredValue(const std::string& section_name, const std::string& key_name, DataType& type) const
+{
+    const StringifiedValue* stored_value = profiler_.profile != nullptr ? FindCounted(section_name, key_name) : Find(section_name, key_name);
+    if(stored_value == nullptr)
+    {
+        return nullptr;
+    }
+    type = stored_value->GetType();
+    return &stored_value->GetValueAsString();
+}
+
+template<typename StoragePolicyT, typename AllocatorT>
+template<typename FunctionT>
+void BasicIniBuffer<StoragePolicyT, AllocatorT>::ForEachSection(FunctionT function) const
+{
+    for(const auto& section : sections_)
+    {
+        function(section.first);
+    }
+}
+
+template<typename StoragePolicyT, typename AllocatorT>
+template<typename FunctionT>
+void BasicIniBuffer<StoragePolicyT, AllocatorT>::ForEachProperty(const std::string& section_name, FunctionT function) const
+{
+    auto section = sections_.find(section_name);
+    if(section == sections_.end())
+    {
+        throw INI_EXCEPTION("Requested Section Name is not present in the data structure. Requested Name: " + section_name);
+    }
+
+    for(const auto& property : section->second.properties_)
+    {
+        function(property.first, property.second.GetValueAsString(), property.second.GetType());
+    }
+}
+
+template<typename StoragePolicyT, typename AllocatorT>
+bool BasicIniBuffer<StoragePolicyT, AllocatorT>::HasSection(const std::string& section_name) const noexcept
+{
+    return sections_.count(section_name) != 0;
+}
+
+template<typename StoragePolicyT, typename AllocatorT>
+size_t BasicIniBuffer<StoragePolicyT, AllocatorT>::GetSectionCount() const noexcept
+{
+    return sections_.size();
+}
+
+template<typename StoragePolicyT, typename AllocatorT>
+template<typename ValueT>
+void BasicIniBuffer<StoragePolicyT, AllocatorT>::AddValue(const std::string& section_name, const std::string& key_name, const ValueT& value)
+{
+    std::string stringified_value;
+    try
+    {
+        stringified_value = Stringify<ValueT>(value);
+    }
+    catch(IniException& e){throw;}
+    catch(std::exception& e){throw INI_EXCEPTION(e.what());}
+    catch(...){throw;}
+
+    const bool is_changed = (HasSubscribers() || IsTracked()) && !IsStored(section_name, key_name, stringified_value);
+
+    if(sections_.find(section_name)!=sections_.end())
+    {
+        sections_[section_name].AddProperty(key_name, stringified_value);
+    }
+    else
+    {
+        Section section(section_name);
+        section.AddProperty(key_name, stringified_value);
+        AddSection(section);
+    }
+
+    if(is_changed)
+    {
+        MarkDirty(section_name);
+        if(HasSubscribers())
+        {
+            RecordChange(section_name, key_name);
+            NotifySubscribers();
+        }
+    }
+}
 
-IniException::IniException(const int line, const std::string& message)
+template<typename StoragePolicyT, typename AllocatorT>
+template<typename ValueT>
+void BasicIniBuffer<StoragePolicyT, AllocatorT>::AddValue(const char* section_name, const char* key_name, const ValueT& value)
 {
-    message_ = "[IniBufferException][File: " + std::string(__FILE__)+"][Line: " + std::to_string(line) + "][What: " + message + "]\n";
+    if(section_name == nullptr || key_name == nullptr)
+    {
+        throw INI_EXCEPTION("Section or key name of the added value is a nullptr.");
+    }
+    internal::LookupKeysScope scope;
+    AssignLookupKeys(scope.keys, section_name, std::strlen(section_name), key_name, std::strlen(key_name));
+    AddValue<ValueT>(scope.keys.section_name, scope.keys.key_name, value);
 }
 
-const char* IniException::what() const throw()
+template<typename StoragePolicyT, typename AllocatorT>
+void BasicIniBuffer<StoragePolicyT, AllocatorT>::AddEmptySection(const std::string& section_name) noexcept
 {
-    return message_.c_str();
+    Section section(section_name);
+    AddSection(section);
 }
 
+template<typename StoragePolicyT, typename AllocatorT>
+void BasicIniBuffer<StoragePolicyT, AllocatorT>::AddSection(const Section& section) noexcept
+{
+    if(!sections_.emplace(section.GetName(), section).second)
+    { // Section already present -> overwrite
+        sections_.at(section.GetName()) = section;
+    }
+}
 
-//-----------------------------------------------------------------------------------
-// Stringified Value
+template<typename StoragePolicyT, typename AllocatorT>
+void BasicIniBuffer<StoragePolicyT, AllocatorT>::EraseSection(const std::string& section_name)
+{
+    auto section = sections_.find(section_name);
+    if(section == sections_.end())
+    {
+        return;
+    }
 
-IniBuffer::Section::StringifiedValue::StringifiedValue() noexcept
-: value_(""),
-  type_(DataType::EMPTY)
-{}
+    if(HasSubscribers())
+    {
+        for(const auto& property : section->second.properties_)
+        {
+            RecordChange(section_name, property.first);
+        }
+    }
+    MarkDirty(section_name);
+    sections_.erase(section);
+    NotifySubscribers();
+}
 
-IniBuffer::Section::StringifiedValue::StringifiedValue(const std::string& value) noexcept
+template<typename StoragePolicyT, typename AllocatorT>
+void BasicIniBuffer<StoragePolicyT, AllocatorT>::EraseSection(const char* section_name)
 {
-    type_ = internal::GetDataType(value);
-    value_ = value;
+    if(section_name != nullptr)
+    {
+        EraseSection(section_name, std::strlen(section_name));
+    }
 }
 
-template<typename ValueT>
-ValueT IniBuffer::Section::StringifiedValue::GetValue() const
+template<typename StoragePolicyT, typename AllocatorT>
+void BasicIniBuffer<StoragePolicyT, AllocatorT>::EraseSection(const char* section_name, size_t section_name_length)
 {
-    try
+    if(section_name != nullptr)
     {
-        return CastValue<ValueT>();
+        internal::LookupKeysScope scope;
+        scope.keys.section_name.assign(section_name, section_name_length);
+        EraseSection(scope.keys.section_name);
     }
-    catch(const std::logic_error& e)
+}
+
+template<typename StoragePolicyT, typename AllocatorT>
+void BasicIniBuffer<StoragePolicyT, AllocatorT>::EraseProperty(const std::string& section_name, const std::string& key_name)
+{
+    auto section = sections_.find(section_name);
+    if(section != sections_.end())
     {
-        throw INI_EXCEPTION("Bad Cast: " + std::string(e.what()));
+        const bool is_changed = (HasSubscribers() || IsTracked()) && section->second.properties_.count(key_name) != 0;
+        section->second.EraseProperty(key_name);
+
+        if(is_changed)
+        {
+            MarkDirty(section_name);
+            if(HasSubscribers())
+            {
+                RecordChange(section_name, key_name);
+                NotifySubscribers();
+            }
+        }
     }
-    catch(...){throw;}
 }
 
-const std::string&  IniBuffer::Section::StringifiedValue::GetValueAsString() const noexcept
+template<typename StoragePolicyT, typename AllocatorT>
+void BasicIniBuffer<StoragePolicyT, AllocatorT>::EraseProperty(const char* section_name, const char* key_name)
 {
-    return value_;
+    if(section_name != nullptr && key_name != nullptr)
+    {
+        EraseProperty(section_name, std::strlen(section_name), key_name, std::strlen(key_name));
+    }
 }
 
-template<>
-std::string IniBuffer::Section::StringifiedValue::CastValue<std::string>() const
+template<typename StoragePolicyT, typename AllocatorT>
+void BasicIniBuffer<StoragePolicyT, AllocatorT>::EraseProperty(const char* section_name, size_t section_name_length, const char* key_name, size_t key_name_length)
 {
-    if(type_ == DataType::STRING)
+    if(section_name != nullptr && key_name != nullptr)
     {
-        return value_;
+        internal::LookupKeysScope scope;
+        AssignLookupKeys(scope.keys, section_name, section_name_length, key_name, key_name_length);
+        EraseProperty(scope.keys.section_name, scope.keys.key_name);
     }
-    else
+}
+
+template<typename StoragePolicyT, typename AllocatorT>
+IniBufferBase::SubscriptionId BasicIniBuffer<StoragePolicyT, AllocatorT>::Subscribe(const std::string& section_name, const std::string& key_name, Callback_t callback)
+{
+    if(!callback)
     {
-        throw INI_EXCEPTION("Stored value is not a std::string.");
+        throw INI_EXCEPTION("Subscribed callback is empty. Section: " + section_name + "; Key: " + key_name);
     }
+
+    const SubscriptionId subscription_id = notifier_.next_id++;
+    notifier_.subscriptions.push_back(Subscription{subscription_id, section_name, key_name, std::move(callback)});
+    return subscription_id;
 }
 
-template<>
-int IniBuffer::Section::StringifiedValue::CastValue<int>() const
+template<typename StoragePolicyT, typename AllocatorT>
+void BasicIniBuffer<StoragePolicyT, AllocatorT>::Unsubscribe(SubscriptionId subscription_id) noexcept
 {
-    try
+    auto& subscriptions = notifier_.subscriptions;
+    subscriptions.erase(std::remove_if(subscriptions.begin(), subscriptions.end(), [subscription_id](const Subscription& subscription)
     {
-        if(type_ == DataType::INT)
-        {
-            return std::stoi(value_);
-        }
-        else
-        {
-            throw INI_EXCEPTION("Stored value is not an int.");
-        }
-    }
-    catch(const std::invalid_argument& e){throw INI_EXCEPTION("Invalid Argument: " + std::string(e.what()));}
-    catch(const std::out_of_range& e){throw INI_EXCEPTION("Out Of Range: " + std::string(e.what()));}
-    catch(const IniException& e){throw;}
-    catch(const std::exception& e){throw INI_EXCEPTION( std::string(e.what()));}
-    catch(...){throw;}
+        return subscription.id == subscription_id;
+    }), subscriptions.end());
 }
 
-template<>
-float IniBuffer::Section::StringifiedValue::CastValue<float>() const
+template<typename StoragePolicyT, typename AllocatorT>
+template<typename ValueT>
+IniBufferBase::BoundValue<ValueT> BasicIniBuffer<StoragePolicyT, AllocatorT>::Bind(const char* section_name, const char* key_name)
 {
-    try
+    if(section_name == nullptr || key_name == nullptr)
     {
-        if(type_ == DataType::FLOAT)
-        {
-            return std::stof(value_);
-        }
-        else
-        {
-            throw INI_EXCEPTION("Stored value is not a float.");
-        }
+        throw INI_EXCEPTION("Bound section or key name is a nullptr.");
     }
-    catch(const std::invalid_argument& e){throw INI_EXCEPTION("Invalid Argument: " + std::string(e.what()));}
-    catch(const std::out_of_range& e){throw INI_EXCEPTION("Out Of Range: " + std::string(e.what()));}
-    catch(const IniException& e){throw;}
-    catch(const std::exception& e){throw INI_EXCEPTION( std::string(e.what()));}
-    catch(...){throw;}
+    return Bind<ValueT>(std::string(section_name), std::string(key_name));
 }
 
-template<>
-bool IniBuffer::Section::StringifiedValue::CastValue<bool>() const
+template<typename StoragePolicyT, typename AllocatorT>
+template<typename ValueT>
+IniBufferBase::BoundValue<ValueT> BasicIniBuffer<StoragePolicyT, AllocatorT>::Bind(const std::string& section_name, const std::string& key_name)
+{
+    static_assert(std::is_same<ValueT, int>::value || std::is_same<ValueT, float>::value || std::is_same<ValueT, bool>::value,
+                  "Bound values must be of type int, float or bool.");
+
+    std::shared_ptr<BoundCell<ValueT>> cell(new BoundCell<ValueT>(section_name, key_name, GetValue<ValueT>(section_name, key_name)));
+    notifier_.bindings.push_back(cell);
+    return BoundValue<ValueT>(cell);
+}
+
+IniBufferBase::BoundCellBase::BoundCellBase(const std::string& section_name, const std::string& key_name)
+: section_name(section_name),
+  key_name(key_name)
+{}
+
+template<typename ValueT>
+IniBufferBase::BoundCell<ValueT>::BoundCell(const std::string& section_name, const std::string& key_name, ValueT initial_value)
+: BoundCellBase(section_name, key_name),
+  value(initial_value)
+{}
+
+template<typename ValueT>
+void IniBufferBase::BoundCell<ValueT>::Update(const StringifiedValue& stored_value) noexcept
 {
     try
     {
-        if(type_ == DataType::BOOL)
-        {
-            if(0 == value_.compare("true") ||
-               0 == value_.compare("TRUE") ||
-               0 == value_.compare("True"))
-            {
-                return true;
-            }
-            else
-            {
-                return false;
-            }
-        }
-        else
-        {
-            throw INI_EXCEPTION("Stored value is not a boolean.");
-        }
+        value.store(stored_value.GetValue<ValueT>(), std::memory_order_relaxed);
     }
-    catch(const std::out_of_range& e){throw INI_EXCEPTION("Out Of Range: " + std::string(e.what()));}
-    catch(const IniException& e){throw;}
-    catch(const std::exception& e){throw INI_EXCEPTION( std::string(e.what()));}
-    catch(...){throw;}
+    catch(...){} // Keeps the last valid value.
 }
 
 template<typename ValueT>
-ValueT IniBuffer::Section::StringifiedValue::CastValue() const
+IniBufferBase::BoundValue<ValueT>::BoundValue(std::shared_ptr<const BoundCell<ValueT>> cell) noexcept
+: cell_(std::move(cell))
+{}
+
+template<typename ValueT>
+ValueT IniBufferBase::BoundValue<ValueT>::Get() const noexcept
 {
-     throw INI_EXCEPTION("Stored value is not supported for typecasting.");
+    return cell_->value.load(std::memory_order_relaxed);
 }
 
+template<typename StoragePolicyT, typename AllocatorT>
+void BasicIniBuffer<StoragePolicyT, AllocatorT>::BeginBatch() noexcept
+{
+    ++notifier_.batch_depth;
+}
 
-IniBuffer::Section::StringifiedValue::~StringifiedValue() noexcept
+template<typename StoragePolicyT, typename AllocatorT>
+void BasicIniBuffer<StoragePolicyT, AllocatorT>::EndBatch()
 {
-    value_ = "";
-    type_ = DataType::EMPTY;
+    if(notifier_.batch_depth == 0)
+    {
+        throw INI_EXCEPTION("EndBatch called without a running batch.");
+    }
+    --notifier_.batch_depth;
+    NotifySubscribers();
 }
 
-//-----------------------------------------------------------------------------------
-// Section
-IniBuffer::Section::Section() noexcept
-: name_("")
+template<typename StoragePolicyT, typename AllocatorT>
+bool BasicIniBuffer<StoragePolicyT, AllocatorT>::HasSubscribers() const noexcept
 {
-    properties_.clear();
+    return !notifier_.subscriptions.empty() || !notifier_.bindings.empty();
 }
 
-IniBuffer::Section::Section(const std::string& name) noexcept
-: name_(name)
+template<typename StoragePolicyT, typename AllocatorT>
+bool BasicIniBuffer<StoragePolicyT, AllocatorT>::IsStored(const std::string& section_name, const std::string& key_name, const std::string& value) const noexcept
 {
-    properties_.clear();
+    const StringifiedValue* stored_value = Find(section_name, key_name);
+    return stored_value != nullptr && stored_value->GetValueAsString() == value;
 }
 
-const std::string& IniBuffer::Section::GetName() const noexcept
+template<typename StoragePolicyT, typename AllocatorT>
+const IniBufferBase::StringifiedValue* BasicIniBuffer<StoragePolicyT, AllocatorT>::Find(const std::string& section_name, const std::string& key_name) const noexcept
 {
-    return name_;
+    auto section = sections_.find(section_name);
+    if(section == sections_.end())
+    {
+        return nullptr;
+    }
+
+    auto property = section->second.properties_.find(key_name);
+    return property != section->second.properties_.end() ? &property->second : nullptr;
 }
 
-template<typename ValueT>
-ValueT IniBuffer::Section::GetValue(const std::string& key_name) const
+template<typename StoragePolicyT, typename AllocatorT>
+void BasicIniBuffer<StoragePolicyT, AllocatorT>::RecordChange(const std::string& section_name, const std::string& key_name)
+{
+    notifier_.pending_changes.emplace(section_name, key_name);
+}
+
+template<typename StoragePolicyT, typename AllocatorT>
+void BasicIniBuffer<StoragePolicyT, AllocatorT>::RecordChanges(const SectionMap_t& previous_sections)
 {
-    if(properties_.find(key_name) != properties_.end())
+    // Erased or modified properties.
+    for(const auto& section : previous_sections)
     {
-        try
+        for(const auto& property : section.second.properties_)
         {
-            return properties_.at(key_name).GetValue<ValueT>();
+            if(!IsStored(section.first, property.first, property.second.GetValueAsString()))
+            {
+                RecordChange(section.first, property.first);
+            }
         }
-        catch(const std::out_of_range& e)
+    }
+
+    // Added properties.
+    for(const auto& section : sections_)
+    {
+        auto previous_section = previous_sections.find(section.first);
+        for(const auto& property : section.second.properties_)
         {
-              throw INI_EXCEPTION(std::string("properties_ variable access out of range: ") + e.what());
+            if(previous_section == previous_sections.end() || previous_section->second.properties_.count(property.first) == 0)
+            {
+                RecordChange(section.first, property.first);
+            }
         }
     }
-    else
+}
+
+template<typename StoragePolicyT, typename AllocatorT>
+void BasicIniBuffer<StoragePolicyT, AllocatorT>::NotifySubscribers()
+{
+    if(notifier_.batch_depth != 0 || notifier_.pending_changes.empty())
     {
-        throw INI_EXCEPTION("Requested key_name is not present in the data structure: " + key_name);
+        return;
+    }
+
+    std::set<std::pair<std::string, std::string>> changes;
+    changes.swap(notifier_.pending_changes);
+
+    // Bound values first, so callbacks already see them updated. Handles which were destroyed are dropped.
+    auto& bindings = notifier_.bindings;
+    bindings.erase(std::remove_if(bindings.begin(), bindings.end(), [&](const std::weak_ptr<BoundCellBase>& binding)
+    {
+        std::shared_ptr<BoundCellBase> cell = binding.lock();
+        if(cell == nullptr)
+        {
+            return true;
+        }
+        if(changes.count(std::make_pair(cell->section_name, cell->key_name)) != 0)
+        {
+            const StringifiedValue* stored_value = Find(cell->section_name, cell->key_name);
+            if(stored_value != nullptr)
+            {
+                cell->Update(*stored_value);
+            }
+        }
+        return false;
+    }), bindings.end());
+
+    // Callbacks may subscribe, unsubscribe or modify the buffer.
+    const std::vector<Subscription> subscriptions = notifier_.subscriptions;
+    std::vector<Change> matching_changes;
+    for(const Subscription& subscription : subscriptions)
+    {
+        matching_changes.clear();
+        for(auto change = changes.lower_bound(std::make_pair(subscription.section_name, std::string()));
+            change != changes.end() && change->first == subscription.section_name;
+            ++change)
+        {
+            if(subscription.key_name == "*" || subscription.key_name == change->second)
+            {
+                matching_changes.push_back(Change{change->first, change->second});
+            }
+        }
+
+        if(!matching_changes.empty())
+        {
+            subscription.callback(matching_changes);
+        }
     }
 }
 
-void IniBuffer::Section::AddProperty(const std::string& key, const std::string& value) noexcept
+template<typename StoragePolicyT, typename AllocatorT>
+template<typename LoadFunctionT>
+void BasicIniBuffer<StoragePolicyT, AllocatorT>::Load(LoadFunctionT load_function)
 {
-    if(properties_.emplace(key, StringifiedValue(value)).second == true)
+    // The loaded content may change any section.
+    MarkAllDirty();
+    if(!HasSubscribers())
     {
+        load_function();
         return;
     }
-    else
-    {   // property is already present. -> overwrite.
-        properties_.at(key) = value;
+
+    const SectionMap_t previous_sections = sections_;
+    BeginBatch();
+    try
+    {
+        load_function();
+    }
+    catch(...)
+    { // Content which was loaded before the error is reported as well.
+        RecordChanges(previous_sections);
+        --notifier_.batch_depth;
+        NotifySubscribers();
+        throw;
     }
+    RecordChanges(previous_sections);
+    EndBatch();
 }
 
-void IniBuffer::Section::EraseProperty(const std::string& key) noexcept
+template<typename StoragePolicyT, typename AllocatorT>
+bool BasicIniBuffer<StoragePolicyT, AllocatorT>::IsTracked() const noexcept
 {
-    properties_.erase(key);
+    return !saved_file_.stamp.fullfilename.empty();
 }
 
-void IniBuffer::Section::WriteSection(std::ofstream& file)
+template<typename StoragePolicyT, typename AllocatorT>
+void BasicIniBuffer<StoragePolicyT, AllocatorT>::MarkDirty(const std::string& section_name)
 {
-    try
+    if(IsTracked() && !saved_file_.all_dirty)
     {
-        file<<"["<<name_<<"]\n";
-        for(auto item : properties_)
-        {
-          file<<item.first<<" = "<<item.second.GetValueAsString()<<"\n";
-        }
-        file<<"\n";
+        saved_file_.dirty_sections.insert(section_name);
     }
-    catch(std::ios_base::failure& e){throw INI_EXCEPTION("Error writing sections to file. Section Name:"+ name_ +"; Message: "+ std::string(e.what()));}
-    catch(...){throw;}
 }
 
-IniBuffer::Section::~Section() noexcept
+template<typename StoragePolicyT, typename AllocatorT>
+void BasicIniBuffer<StoragePolicyT, AllocatorT>::MarkAllDirty() noexcept
 {
-    properties_.clear();
+    if(IsTracked())
+    {
+        saved_file_.all_dirty = true;
+        saved_file_.dirty_sections.clear();
+    }
 }
 
-//-----------------------------------------------------------------------------------
-// IniBuffer
+template<typename StoragePolicyT, typename AllocatorT>
+bool BasicIniBuffer<StoragePolicyT, AllocatorT>::IsDirty() const noexcept
+{
+    return saved_file_.all_dirty || !saved_file_.dirty_sections.empty();
+}
 
-void IniBuffer::LoadFile(const std::string& fullfilename)
+template<typename StoragePolicyT, typename AllocatorT>
+void BasicIniBuffer<StoragePolicyT, AllocatorT>::Save()
 {
+    if(!IsTracked())
+    {
+        throw INI_EXCEPTION("Changes are not tracked. Save requires a buffer which was empty when LoadFile loaded a file without include directives.");
+    }
+    const std::string fullfilename = saved_file_.stamp.fullfilename;
+    if(!internal::IsUnchanged(saved_file_.stamp))
+    {
+        throw INI_EXCEPTION("The file was modified since it was loaded or saved: " + fullfilename);
+    }
+    if(!IsDirty())
+    {
+        return;
+    }
+
     try
     {
-        return ParseFile(fullfilename);
+#if !defined(_WIN32)
+        SaveChanges();
+#else
+        WriteFile(fullfilename, false);
+#endif
     }
-    catch(IniException& e) {throw;}
-    catch(std::exception& e){throw INI_EXCEPTION( e.what());}
+    catch(IniException& e){throw;}
+    catch(std::exception& e){throw INI_EXCEPTION(e.what());}
     catch(...){throw;}
+
+    internal::GetFileStamp(fullfilename, saved_file_.stamp);
+    saved_file_.dirty_sections.clear();
+    saved_file_.all_dirty = false;
+    LOG("Saved changes to disk: "+fullfilename);
 }
 
-void IniBuffer::WriteFile(const std::string& fullfilename) const
+#if !defined(_WIN32)
+template<typename StoragePolicyT, typename AllocatorT>
+void BasicIniBuffer<StoragePolicyT, AllocatorT>::SaveChanges()
 {
-    std::ofstream file;
-    file.exceptions(std::ofstream::failbit);
-    try
+    const std::string& fullfilename = saved_file_.stamp.fullfilename;
+    const size_t file_size = static_cast<size_t>(saved_file_.stamp.size);
+    if(!saved_file_.has_ranges)
     {
-        file.open (fullfilename, std::ios::out | std::ios::trunc);
+        saved_file_.ranges = internal::FindSectionRanges(fullfilename, file_size, saved_file_.ends_with_line_break);
+        saved_file_.has_ranges = true;
     }
-    catch(std::ios_base::failure& e){throw INI_EXCEPTION("Can not open file. Maybe fullfilename is invalid. Filename: "+fullfilename);}
-    try
+    const std::vector<internal::SectionRange>& ranges = saved_file_.ranges;
+
+    // The new file is a sequence of ranges copied from the file and formatted sections.
+    struct Piece
+    {
+        size_t source_offset;
+        size_t size;
+        std::string content;
+        bool is_copy;
+    };
+    std::vector<Piece> pieces;
+    size_t output_size = 0;
+    auto copy = [&pieces, &output_size](size_t begin, size_t end)
+    {
+        if(end > begin)
+        {
+            pieces.push_back(Piece{begin, end - begin, std::string(), true});
+            output_size += end - begin;
+        }
+    };
+    auto format = [&pieces, &output_size](const Section& section, size_t replaced_offset)
+    {
+        pieces.push_back(Piece{replaced_offset, 0, std::string(), false});
+        internal::StringSink sink(pieces.back().content);
+        section.WriteSection(sink);
+        pieces.back().size = pieces.back().content.size();
+        output_size += pieces.back().size;
+    };
+    auto ends_with_file_end = [file_size](const std::vector<Piece>& pieces)
     {
-        file << "# Configuration File\n";
-        file << "# "<<GetDateTime()<<"\n\n";
+        return !pieces.empty() && pieces.back().is_copy && pieces.back().source_offset + pieces.back().size == file_size;
+    };
+
+    // Ranges of the sections in the new file, which replace the current ones after writing.
+    std::vector<internal::SectionRange> new_ranges;
 
-        for(auto item : sections_)
+    // Stays set as long as every formatted section replaces a range of the same size.
+    bool is_in_place = true;
+    std::set<std::string> file_sections;
+    copy(0, ranges.empty() ? file_size : ranges.front().begin);
+    for(const internal::SectionRange& range : ranges)
+    {
+        const bool is_repeated = !file_sections.insert(range.section_name).second;
+        const size_t begin = output_size;
+        if(!saved_file_.all_dirty && saved_file_.dirty_sections.count(range.section_name) == 0)
         {
-            item.second.WriteSection(file);
+            copy(range.begin, range.end);
+            new_ranges.push_back(internal::SectionRange{range.section_name, begin, begin + range.header - range.begin, output_size});
+            continue;
         }
 
-        file.close();
-        LOG("Wrote ini-file to disk: "+fullfilename);
+        // Erased sections and repeated occurrences of a changed section are dropped.
+        auto section = sections_.find(range.section_name);
+        if(section == sections_.end() || is_repeated)
+        {
+            is_in_place = false;
+            continue;
+        }
+        copy(range.begin, range.header);
+        const size_t header = output_size;
+        format(section->second, range.header);
+        new_ranges.push_back(internal::SectionRange{range.section_name, begin, header, output_size});
+        is_in_place = is_in_place && pieces.back().size == range.end - range.header;
     }
-    catch(std::ios_base::failure& e){throw INI_EXCEPTION("Error writing header to file: " + std::string(e.what()));}
-    catch(IniException& e){throw;}
-    catch(std::exception& e){throw INI_EXCEPTION(e.what());}
-    catch(...){throw;}
-}
 
-void IniBuffer::Clear() noexcept
-{
-    sections_.clear();
-    LOG("Cleared IniBuffer.");
-}
+    // Comments behind the last section lead the first appended section.
+    const bool has_epilogue = !ranges.empty() && ranges.back().end < file_size;
+    const size_t epilogue_begin = output_size;
+    if(has_epilogue)
+    {
+        copy(ranges.back().end, file_size);
+    }
 
-template<typename ValueT>
-ValueT IniBuffer::GetValue(const std::string& section_name, const std::string& key_name) const
-{
-    if(sections_.find(section_name) != sections_.end())
+    bool is_first_appended = true;
+    for(const auto& item : sections_)
+    {
+        if(file_sections.count(item.first) == 0)
+        {
+            if(is_first_appended && !saved_file_.ends_with_line_break && ends_with_file_end(pieces))
+            { // The last line of the file lacks its line break.
+                pieces.push_back(Piece{0, 1, std::string(1, '\n'), false});
+                ++output_size;
+                if(!has_epilogue && !new_ranges.empty())
+                {
+                    ++new_ranges.back().end;
+                }
+            }
+            const size_t begin = (has_epilogue && is_first_appended) ? epilogue_begin : output_size;
+            const size_t header = output_size;
+            format(item.second, 0);
+            new_ranges.push_back(internal::SectionRange{item.first, begin, header, output_size});
+            is_first_appended = false;
+            is_in_place = false;
+        }
+    }
+
+    // Formatted sections end with a line break, copied ranges as well unless they reach the end of the file.
+    const bool ends_with_line_break = ends_with_file_end(pieces) ? saved_file_.ends_with_line_break :
+                                      pieces.empty() || pieces.back().is_copy || pieces.back().content.back() == '\n';
+
+    if(is_in_place)
     {
-        // std::out_of_range exception is impossible because of check in "if"
-        return sections_.at(section_name).GetValue<ValueT>(key_name);
+        const int file_descriptor = open(fullfilename.c_str(), O_WRONLY);
+        if(file_descriptor < 0)
+        {
+            throw INI_EXCEPTION("Can not open file: " + fullfilename);
+        }
+        bool is_written = true;
+        for(const Piece& piece : pieces)
+        {
+            if(!piece.is_copy)
+            {
+                is_written = is_written && internal::WriteAt(file_descriptor, piece.content.data(), piece.size, piece.source_offset);
+            }
+        }
+        if(close(file_descriptor) != 0 || !is_written)
+        {
+            saved_file_.has_ranges = false;
+            throw INI_EXCEPTION("Error writing to file: " + fullfilename);
+        }
+        saved_file_.ends_with_line_break = ends_with_line_break;
+        return;
     }
-    else
+
+    // The new content replaces the file only once it is written completely.
+    const std::string temporary_fullfilename = fullfilename + ".tmp";
+    const int source_fd = open(fullfilename.c_str(), O_RDONLY);
+    struct stat file_status;
+    if(source_fd < 0 || fstat(source_fd, &file_status) != 0)
     {
-        throw INI_EXCEPTION("Requested Section Name is not present in the data structure. Requested Name: " + section_name);
+        if(source_fd >= 0)
+        {
+            close(source_fd);
+        }
+        throw INI_EXCEPTION("Can not open file: " + fullfilename);
     }
-}
-
-template<typename ValueT>
-void IniBuffer::AddValue(const std::string& section_name, const std::string& key_name, const ValueT& value)
-{
-    std::string stringified_value;
-    try
+    const int destination_fd = open(temporary_fullfilename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, file_status.st_mode & 07777);
+    if(destination_fd < 0)
     {
-        stringified_value = Stringify<ValueT>(value);
+        close(source_fd);
+        throw INI_EXCEPTION("Can not open file: " + temporary_fullfilename);
     }
-    catch(IniException& e){throw;}
-    catch(std::exception& e){throw INI_EXCEPTION(e.what());}
-    catch(...){throw;}
 
-    if(sections_.find(section_name)!=sections_.end())
+    bool is_written = true;
+    size_t offset = 0;
+    for(const Piece& piece : pieces)
     {
-        sections_[section_name].AddProperty(key_name, stringified_value);
+        is_written = is_written && (piece.is_copy ?
+            internal::CopyRange(source_fd, piece.source_offset, destination_fd, offset, piece.size) :
+            internal::WriteAt(destination_fd, piece.content.data(), piece.size, offset));
+        offset += piece.size;
     }
-    else
+    close(source_fd);
+    is_written = close(destination_fd) == 0 && is_written;
+    if(!is_written || rename(temporary_fullfilename.c_str(), fullfilename.c_str()) != 0)
     {
-        Section section(section_name);
-        section.AddProperty(key_name, stringified_value);
-        AddSection(section);
+        unlink(temporary_fullfilename.c_str());
+        throw INI_EXCEPTION("Error writing to file: " + fullfilename);
     }
+    saved_file_.ranges.swap(new_ranges);
+    saved_file_.ends_with_line_break = ends_with_line_break;
 }
+#endif
 
-void IniBuffer::AddEmptySection(const std::string& section_name) noexcept
-{
-    Section section(section_name);
-    AddSection(section);
-}
+constexpr size_t IniBufferBase::max_include_depth;
+constexpr size_t IniBufferBase::write_chunk_size;
+constexpr size_t IniBufferBase::parallel_write_min_size;
 
-void IniBuffer::AddSection(const Section& section) noexcept
+template<typename StoragePolicyT, typename AllocatorT>
+void BasicIniBuffer<StoragePolicyT, AllocatorT>::ParseFile(const std::string& fullfilename, IncludeContext& context)
 {
-    if(!sections_.emplace(section.GetName(), section).second)
-    { // Section already present -> overwrite
-        sections_.at(section.GetName()) = section;
-    }
+    internal::FileStamp stamp{fullfilename, 0, 0, 0};
+    internal::GetFileStamp(fullfilename, stamp);
+    context.dependencies.push_back(stamp);
+    context.chain.push_back(fullfilename);
+
+    Loader loader(*this, fullfilename, context);
+    IniReader reader(loader);
+    reader.ReadFile(fullfilename);
 }
 
-void IniBuffer::EraseSection(const std::string& section_name) noexcept
+template<typename StoragePolicyT, typename AllocatorT>
+BasicIniBuffer<StoragePolicyT, AllocatorT>::Loader::Loader(BasicIniBuffer& buffer, const std::string& fullfilename, IncludeContext& context) noexcept
+: buffer_(buffer),
+  fullfilename_(fullfilename),
+  context_(context),
+  current_section_(nullptr)
+{}
+
+template<typename StoragePolicyT, typename AllocatorT>
+void BasicIniBuffer<StoragePolicyT, AllocatorT>::Loader::OnSection(const StringView& section_name, size_t)
 {
-    sections_.erase(section_name);
+    // The first definition replaces a section loaded before, repeated definitions are merged into it.
+    std::string name = section_name.ToString();
+    if(defined_sections_.insert(name).second)
+    {
+        buffer_.AddEmptySection(name);
+    }
+    current_section_ = &buffer_.sections_.at(name);
 }
 
-void IniBuffer::EraseProperty(const std::string& section_name, const std::string& key_name) noexcept
+template<typename StoragePolicyT, typename AllocatorT>
+void BasicIniBuffer<StoragePolicyT, AllocatorT>::Loader::OnProperty(const StringView& key_name, const StringView& value, size_t)
 {
-
-    sections_.at(section_name).EraseProperty(key_name);
-
+    current_section_->AddProperty(key_name.ToString(), value.ToString());
 }
 
-void IniBuffer::ParseFile(const std::string& fullfilename)
+template<typename StoragePolicyT, typename AllocatorT>
+void BasicIniBuffer<StoragePolicyT, AllocatorT>::Loader::OnInclude(const StringView& path, size_t line_nr)
 {
-    std::ifstream fstrm;
-
-    fstrm.exceptions(std::ifstream::failbit);
-
-    std::string line;
-    std::string current_section_name;
-    size_t pos = 0;
-    size_t line_nr = 0;
+    std::string included_file = internal::ResolveIncludePath(fullfilename_, path.ToString());
 
-    try
+    if(std::find(context_.chain.begin(), context_.chain.end(), included_file) != context_.chain.end())
     {
-        fstrm.open(fullfilename);
+        throw INI_EXCEPTION("Invalid ini-file. Include cycle detected: " + included_file + " Line: " + std::to_string(line_nr));
     }
-    catch(std::ios_base::failure& e)
+    if(context_.chain.size() >= max_include_depth)
     {
-        throw INI_EXCEPTION("Opening file failed: " + fullfilename);
+        throw INI_EXCEPTION("Invalid ini-file. Includes are nested too deep. Line: " + std::to_string(line_nr));
     }
 
-    while(true)
+    // The included content is merged as a whole, with the same rules as a repeated section header.
+    // The current section stays active afterwards.
+    // Depending on the storage, merging moves the sections, so the current one is looked up again.
+    std::shared_ptr<const IniBuffer> included_buffer = IniCache::Get(included_file, context_);
+    const std::string current_section_name = current_section_ != nullptr ? current_section_->GetName() : std::string();
+    for(const auto& section : included_buffer->sections_)
     {
-        ++line_nr;
-
-        try
-        {
-            getline(fstrm, line);
-        }
-        catch(std::ios_base::failure& e)
-        {
-            if(fstrm.eof()){LOG("Reached end of ini file."); break;}
-            else {throw;}
-        }
-
-        TrimComment(line);
-        TrimWhitespace(line);
-
-        // Empty line
-        if (line.empty())
-        {
-            continue;
-        }
-
-        // Comment
-        if (line[0] == ';' || line[0] == '#')
-        {
-            continue;
-        }
-
-        // Section
-        else if (line[0] == '[')
+        if(defined_sections_.insert(section.first).second)
         {
-            pos = line.find_first_of(']');
-            if (pos == std::string::npos)
-            {
-                throw INI_EXCEPTION("Ivalid ini-file ] is missing in section. Line: " + std::to_string(line_nr));
-            }
-            else
-            {
-                current_section_name = line.substr(1, pos - 1);
-                TrimWhitespace(current_section_name);
-                AddEmptySection(current_section_name);
-            }
+            buffer_.AddEmptySection(section.first);
         }
+    }
+    buffer_.MergeBuffer(*included_buffer);
+    if(current_section_ != nullptr)
+    {
+        current_section_ = &buffer_.sections_.at(current_section_name);
+    }
+}
 
-        // Property
-        else if((pos = line.find_first_of("=")) != std::string::npos)
+template<typename StoragePolicyT, typename AllocatorT>
+template<typename BufferT>
+void BasicIniBuffer<StoragePolicyT, AllocatorT>::MergeBuffer(const BufferT& buffer) noexcept
+{
+    for(const auto& section : buffer.sections_)
+    {
+        auto merged_section = sections_.find(section.first);
+        if(merged_section == sections_.end())
         {
-            if(current_section_name.empty())
-            {
-                throw INI_EXCEPTION("Invalid ini-file. Property must belong to a section. Line: " + std::to_string(line_nr));
-            }
-            std::string key_name = line.substr(0, pos);
-            std::string value = "";
-            try
-            {
-                value = line.substr(pos + 1);
-                TrimWhitespace(key_name);
-                TrimWhitespace(value);
-            }
-            catch(const std::out_of_range& e){throw INI_EXCEPTION("Invalid ini-file. Value is missing. Line: " + std::to_string(line_nr));}
-
-            if(ContainsWhiteSpace(key_name))
-            {
-                throw INI_EXCEPTION("Invalid ini-file. Key contains white spaces: " + std::to_string(line_nr));
-            }
-            try
-            {
-                AddValue(current_section_name, key_name, value);
-            }
-            catch(IniException& e){throw;}
-            catch(std::exception& e){throw INI_EXCEPTION(e.what());}
-            catch(...){throw;}
+            merged_section = sections_.emplace(section.first, Section(section.first)).first;
         }
-        else
+        for(const auto& property : section.second.properties_)
         {
-            throw INI_EXCEPTION("Invalid ini-file. Line is not a valid ini-file component: " + std::to_string(line_nr));
+            merged_section->second.properties_[property.first] = property.second;
         }
     }
 }
 
 template<>
-std::string IniBuffer::Stringify<std::string>(const std::string& value) const
+std::string IniBufferBase::Stringify<std::string>(const std::string& value)
 {
     return value;
 }
 
 template<>
-std::string IniBuffer::Stringify<int>(const int& value) const
+std::string IniBufferBase::Stringify<int>(const int& value)
 {
     try {return std::to_string(value);}
     catch(const std::length_error& e){throw INI_EXCEPTION("Stringified value is too long. length_error: "+std::string(e.what()));}
@@ -736,7 +3229,7 @@ std::string IniBuffer::Stringify<int>(const int& value) const
 }
 
 template<>
-std::string IniBuffer::Stringify<float>(const float& value) const
+std::string IniBufferBase::Stringify<float>(const float& value)
 {
     try {return std::to_string(value);}
     catch(const std::length_error& e){throw INI_EXCEPTION("Stringified value is too long. length_error: "+std::string(e.what()));}
@@ -744,7 +3237,7 @@ std::string IniBuffer::Stringify<float>(const float& value) const
 }
 
 template<>
-std::string IniBuffer::Stringify<bool>(const bool& value) const
+std::string IniBufferBase::Stringify<bool>(const bool& value)
 {
     if(value==true)
     {
@@ -757,17 +3250,132 @@ std::string IniBuffer::Stringify<bool>(const bool& value) const
 }
 
 template<typename ValueT>
-std::string IniBuffer::Stringify(const ValueT& value) const
+std::string IniBufferBase::Stringify(const ValueT& value)
 {
     throw INI_EXCEPTION("The Requestet Datatype is not supported to stringify.");
 }
 
+//-----------------------------------------------------------------------------------
+// IniCache
+
+constexpr size_t IniCache::default_memory_budget;
+
+std::shared_ptr<const IniBuffer> IniCache::Get(const std::string& fullfilename)
+{
+    try
+    {
+        IniBuffer::IncludeContext context;
+        return Get(fullfilename, context);
+    }
+    catch(IniException& e) {throw;}
+    catch(std::exception& e){throw INI_EXCEPTION( e.what());}
+    catch(...){throw;}
+}
+
+void IniCache::SetMemoryBudget(size_t bytes) noexcept
+{
+    State& state = GetState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.memory_budget = bytes;
+    Evict(state);
+}
+
+size_t IniCache::GetMemoryUsage() noexcept
+{
+    State& state = GetState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    return state.memory_usage;
+}
+
+void IniCache::Clear() noexcept
+{
+    State& state = GetState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.entries.clear();
+    state.usage.clear();
+    state.memory_usage = 0;
+    LOG("Cleared IniCache.");
+}
+
+IniCache::State& IniCache::GetState() noexcept
+{
+    static State state;
+    return state;
+}
+
+std::shared_ptr<const IniBuffer> IniCache::Get(const std::string& fullfilename, IniBuffer::IncludeContext& context)
+{
+    State& state = GetState();
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        auto cached = state.entries.find(fullfilename);
+        if(cached != state.entries.end())
+        {
+            Entry& entry = cached->second;
+            if(std::all_of(entry.dependencies.begin(), entry.dependencies.end(), internal::IsUnchanged))
+            {
+                LOG("Reused cached file: "+fullfilename);
+                state.usage.splice(state.usage.begin(), state.usage, entry.usage);
+                context.dependencies.insert(context.dependencies.end(), entry.dependencies.begin(), entry.dependencies.end());
+                return entry.buffer;
+            }
+
+            // Outdated
+            state.memory_usage -= entry.memory_usage;
+            state.usage.erase(entry.usage);
+            state.entries.erase(cached);
+        }
+    }
+
+    // Parsing happens outside of the lock, nested includes access the cache again.
+    IniBuffer::IncludeContext nested_context;
+    nested_context.chain = context.chain;
+    std::shared_ptr<IniBuffer> buffer(new IniBuffer());
+    buffer->ParseFile(fullfilename, nested_context);
+    context.dependencies.insert(context.dependencies.end(), nested_context.dependencies.begin(), nested_context.dependencies.end());
+
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        auto cached = state.entries.find(fullfilename);
+        if(cached != state.entries.end())
+        { // Parsed concurrently by another thread -> replace
+            state.memory_usage -= cached->second.memory_usage;
+            state.usage.erase(cached->second.usage);
+            state.entries.erase(cached);
+        }
+
+        state.usage.push_front(fullfilename);
+        Entry entry{nested_context.dependencies, buffer, buffer->GetMemoryUsage(), state.usage.begin()};
+        state.memory_usage += entry.memory_usage;
+        state.entries.emplace(fullfilename, entry);
+        Evict(state);
+    }
+    return buffer;
+}
+
+void IniCache::Evict(State& state) noexcept
+{
+    while(state.memory_usage > state.memory_budget && state.usage.size() > 1)
+    {
+        auto evicted = state.entries.find(state.usage.back());
+        LOG("Evicted cached file: "+evicted->first);
+        state.memory_usage -= evicted->second.memory_usage;
+        state.entries.erase(evicted);
+        state.usage.pop_back();
+    }
+}
+
 std::string GetDateTime() noexcept
 {
     time_t now = time(0);
     struct tm  time_struct;
     char buf[80];
-    time_struct = *localtime(&now);
+    // Files may be written from several threads at once. localtime returns a shared object.
+#if defined(_WIN32)
+    localtime_s(&time_struct, &now);
+#else
+    localtime_r(&now, &time_struct);
+#endif
     strftime(buf, sizeof(buf), "%Y/%m/%d %X", &time_struct);
     return buf;
 }
@@ -777,12 +3385,12 @@ std::string GetDateTime() noexcept
 
 namespace internal
 {
-    IniBuffer::DataType GetDataType(const std::string& str) noexcept
+    IniBufferBase::DataType GetDataType(const std::string& str) noexcept
     {
         std::string::size_type start_pos = 0;
         if((start_pos = str.find_first_not_of(" ", start_pos)) == std::string::npos)
         {
-            return IniBuffer::DataType::EMPTY;
+            return IniBufferBase::DataType::EMPTY;
         }
 
         if(0 == str.compare("true") ||
@@ -792,7 +3400,7 @@ namespace internal
            0 == str.compare("FALSE") ||
            0 == str.compare("False"))
         {
-            return IniBuffer::DataType::BOOL;
+            return IniBufferBase::DataType::BOOL;
         }
 
         if((str[start_pos] == '-') || str[start_pos] == '+')
@@ -802,16 +3410,319 @@ namespace internal
 
         if(str.find_first_not_of("0123456789.", start_pos) != std::string::npos)
         {
-             return IniBuffer::DataType::STRING;
+             return IniBufferBase::DataType::STRING;
         }
         else if(str.find_first_of(".", start_pos) == std::string::npos)
         {
-            return IniBuffer::DataType::INT;
+            return IniBufferBase::DataType::INT;
         }
         else
         {
-            return IniBuffer::DataType::FLOAT;
+            return IniBufferBase::DataType::FLOAT;
+        }
+    }
+
+    bool GetFileStamp(const std::string& fullfilename, FileStamp& stamp) noexcept
+    {
+        struct stat file_status;
+        if(stat(fullfilename.c_str(), &file_status) != 0)
+        {
+            return false;
+        }
+        stamp.fullfilename = fullfilename;
+        stamp.size = file_status.st_size;
+#if defined(__APPLE__)
+        stamp.mtime_ns = file_status.st_mtimespec.tv_sec*1000000000LL + file_status.st_mtimespec.tv_nsec;
+#elif defined(_WIN32)
+        stamp.mtime_ns = file_status.st_mtime*1000000000LL;
+#else
+        stamp.mtime_ns = file_status.st_mtim.tv_sec*1000000000LL + file_status.st_mtim.tv_nsec;
+#endif
+        stamp.inode = file_status.st_ino;
+        return true;
+    }
+
+#if !defined(_WIN32)
+    bool CopyRange(int source_fd, size_t source_offset, int destination_fd, size_t destination_offset, size_t size) noexcept
+    {
+#if defined(__linux__) && defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 27))
+        // Copies inside the kernel. File systems with reflinks share the blocks instead.
+        while(size > 0)
+        {
+            loff_t source_position = static_cast<loff_t>(source_offset);
+            loff_t destination_position = static_cast<loff_t>(destination_offset);
+            const ssize_t copied = copy_file_range(source_fd, &source_position, destination_fd, &destination_position, size, 0);
+            if(copied < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if(copied <= 0)
+            {
+                break;
+            }
+            source_offset += static_cast<size_t>(copied);
+            destination_offset += static_cast<size_t>(copied);
+            size -= static_cast<size_t>(copied);
+        }
+#endif
+#if defined(__linux__)
+        // sendfile writes at the position of the destination.
+        if(size > 0 && lseek(destination_fd, static_cast<off_t>(destination_offset), SEEK_SET) >= 0)
+        {
+            while(size > 0)
+            {
+                off_t source_position = static_cast<off_t>(source_offset);
+                const ssize_t copied = sendfile(destination_fd, source_fd, &source_position, size);
+                if(copied < 0 && errno == EINTR)
+                {
+                    continue;
+                }
+                if(copied <= 0)
+                {
+                    break;
+                }
+                source_offset += static_cast<size_t>(copied);
+                destination_offset += static_cast<size_t>(copied);
+                size -= static_cast<size_t>(copied);
+            }
+        }
+#endif
+        char buffer[64*1024];
+        while(size > 0)
+        {
+            const ssize_t count = pread(source_fd, buffer, std::min(size, sizeof(buffer)), static_cast<off_t>(source_offset));
+            if(count < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if(count <= 0 || !WriteAt(destination_fd, buffer, static_cast<size_t>(count), destination_offset))
+            {
+                return false;
+            }
+            source_offset += static_cast<size_t>(count);
+            destination_offset += static_cast<size_t>(count);
+            size -= static_cast<size_t>(count);
+        }
+        return true;
+    }
+
+    bool WriteAt(int file_descriptor, const char* data, size_t size, size_t offset) noexcept
+    {
+        while(size > 0)
+        {
+            const ssize_t written = pwrite(file_descriptor, data, size, static_cast<off_t>(offset));
+            if(written < 0)
+            {
+                if(errno == EINTR)
+                {
+                    continue;
+                }
+                return false;
+            }
+            data += written;
+            size -= static_cast<size_t>(written);
+            offset += static_cast<size_t>(written);
+        }
+        return true;
+    }
+#endif
+
+    std::vector<SectionRange> FindSectionRanges(const std::string& fullfilename, size_t file_size, bool& ends_with_line_break)
+    {
+        // Blank lines behind the last property belong to a section, comments in front of the next header to the next section.
+        class Scanner: public IniHandler
+        {
+            public:
+
+            void OnSection(const StringView& section_name, size_t) override
+            {
+                const size_t header = reader->GetLineOffset();
+                OnLineAfterContent(header);
+                const size_t begin = ranges.empty() ? header : content_end;
+                if(!ranges.empty())
+                {
+                    ranges.back().end = begin;
+                }
+                ranges.push_back(SectionRange{section_name.ToString(), begin, header, 0});
+                OnContentLine();
+            }
+
+            void OnProperty(const StringView&, const StringView&, size_t) override
+            {
+                OnContentLine();
+            }
+
+            void OnComment(const StringView&, size_t) override
+            {
+                // Only comments on lines of their own separate sections, an inline comment is part of its content line.
+                if(reader->GetLineOffset() != content_line)
+                {
+                    OnLineAfterContent(reader->GetLineOffset());
+                }
+            }
+
+            /// The current line holds a header or a property.
+            void OnContentLine() noexcept
+            {
+                content_line = reader->GetLineOffset();
+                content_end = reader->GetLineEndOffset();
+                is_after_content = true;
+            }
+
+            /// Lines between the last content line and the given offset are blank.
+            void OnLineAfterContent(size_t line_offset) noexcept
+            {
+                if(is_after_content)
+                {
+                    content_end = line_offset;
+                    is_after_content = false;
+                }
+            }
+
+            void OnInclude(const StringView&, size_t line_nr) override
+            {
+                throw INI_EXCEPTION("Files with include directives are not supported. Line: " + std::to_string(line_nr));
+            }
+
+            const IniReader* reader = nullptr;
+            std::vector<SectionRange> ranges;
+            size_t content_line = std::numeric_limits<size_t>::max();
+            size_t content_end = 0;
+            bool is_after_content = false;
+        };
+
+        Scanner scanner;
+        IniReader reader(scanner);
+        scanner.reader = &reader;
+        reader.ReadFile(fullfilename);
+        ends_with_line_break = reader.EndsWithLineBreak();
+        if(!scanner.ranges.empty())
+        {
+            // Comments behind the last section are kept apart, so they survive when it is rewritten.
+            scanner.ranges.back().end = scanner.is_after_content ? file_size : scanner.content_end;
+        }
+        return scanner.ranges;
+    }
+
+    LookupKeysScope::LookupKeysScope()
+    : keys(Acquire())
+    {}
+
+    LookupKeysScope::~LookupKeysScope() noexcept
+    {
+        --GetStack().depth;
+    }
+
+    LookupKeysScope::Stack& LookupKeysScope::GetStack() noexcept
+    {
+        thread_local Stack stack;
+        return stack;
+    }
+
+    LookupKeys& LookupKeysScope::Acquire()
+    {
+        Stack& stack = GetStack();
+        if(stack.depth == stack.keys.size())
+        {
+            stack.keys.emplace_back(new LookupKeys());
+        }
+        return *stack.keys[stack.depth++];
+    }
+
+    constexpr size_t AccessProfile::shard_count;
+
+    void AccessProfile::RecordMiss(const std::string& section_name, const std::string& key_name)
+    {
+        Shard& shard = GetShard();
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        Increment(shard.misses, section_name, key_name);
+    }
+
+    void AccessProfile::Collect(Counts_t& misses) const
+    {
+        for(const Shard& shard : shards_)
+        {
+            std::lock_guard<std::mutex> lock(const_cast<std::mutex&>(shard.mutex));
+            for(const auto& section : shard.misses)
+            {
+                for(const auto& key : section.second)
+                {
+                    misses[section.first][key.first] += key.second;
+                }
+            }
+        }
+    }
+
+    void AccessProfile::Increment(Counts_t& counts, const std::string& section_name, const std::string& key_name)
+    {
+        auto section = counts.find(section_name);
+        if(section == counts.end())
+        {
+            section = counts.emplace(section_name, std::map<std::string, uint64_t>()).first;
+        }
+
+        auto key = section->second.find(key_name);
+        if(key == section->second.end())
+        {
+            key = section->second.emplace(key_name, 0).first;
+        }
+        ++key->second;
+    }
+
+    AccessProfile::Shard& AccessProfile::GetShard() noexcept
+    {
+        static std::atomic<size_t> next_shard(0);
+        thread_local size_t shard_index = next_shard++ % shard_count;
+        return shards_[shard_index];
+    }
+
+    bool IsUnchanged(const FileStamp& stamp) noexcept
+    {
+        FileStamp current{stamp.fullfilename, 0, 0, 0};
+        return GetFileStamp(stamp.fullfilename, current) &&
+               current.size == stamp.size &&
+               current.mtime_ns == stamp.mtime_ns &&
+               current.inode == stamp.inode;
+    }
+
+    size_t GetHeapSize(const std::string& str) noexcept
+    {
+        const char* object = reinterpret_cast<const char*>(&str);
+        if(str.data() >= object && str.data() < object + sizeof(str))
+        {
+            return 0;
+        }
+        return str.capacity() + 1;
+    }
+
+    std::string ResolveIncludePath(const std::string& including_file, const std::string& included_file)
+    {
+        const bool is_absolute = (!included_file.empty() && (included_file[0] == '/' || included_file[0] == '\\')) ||
+                                 (included_file.size() > 1 && included_file[1] == ':');
+        if(is_absolute)
+        {
+            return included_file;
+        }
+
+        size_t pos = including_file.find_last_of("/\\");
+        if(pos == std::string::npos)
+        {
+            return included_file;
+        }
+        return including_file.substr(0, pos + 1) + included_file;
+    }
+
+    std::string GetIncludeBase(const std::string& base_directory)
+    {
+        if(base_directory.empty() || base_directory.back() == '/' || base_directory.back() == '\\')
+        {
+            return base_directory;
         }
+        return base_directory + '/';
     }
 }
+
+// IniBuffer::Freeze is implemented together with the FrozenIni.
+#include"frozen_ini.h"
+
 #endif
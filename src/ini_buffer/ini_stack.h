@@ -0,0 +1,381 @@
+/**
+ * @file ini_stack.h
+ * @author Pascal Enderli
+ * @date 2026.10.18
+ * @brief Layered overlay of several IniBuffers with a precomputed resolution index.
+ */
+
+#ifndef INI_STACK_H_
+#define INI_STACK_H_
+
+#include<map>
+#include<memory>
+#include<vector>
+#include"ini_buffer.h"
+
+//===================================================================================
+// IniStack class declaration
+
+/** Layers several IniBuffers with increasing precedence (e.g. defaults, site, host, env).
+*   @n Every key is resolved to the top most layer which contains it. The result is kept in an index,
+*   @n so a lookup costs one probe into the index instead of one probe per layer.
+*   @n If a layer is replaced or reloaded, only the keys of the old and the new layer content are resolved again.
+*   @n Errors are reported using IniExceptions.
+*/
+class IniStack
+{
+    public:
+
+    /// Identifier of a layer. Layers are numbered in the order they are pushed, starting at 0 (lowest precedence).
+    using LayerId = size_t;
+
+    //===================================================================================
+    // Begin of public IniStack Interface
+
+    /** Puts a buffer on top of the stack. It has precedence over all layers pushed before.
+    *
+    *   @param layer The content of the new layer.
+    *
+    *   @return The identifier of the new layer.
+    */
+    LayerId PushLayer(IniBuffer layer);
+
+    /** Replaces the content of an existing layer.
+    *
+    *   @details
+    *   Only the keys present in the old or in the new content of the layer are resolved again.
+    *   @n If the layer does not exist or resolving fails, an IniException is thrown and the stack keeps its previous state.
+    */
+    void ReplaceLayer(LayerId layer_id, IniBuffer layer);
+
+    /** Loads a file from disk and replaces the content of an existing layer with it.
+    *
+    *   @details
+    *   If parsing fails, an IniException is thrown and the stack keeps its previous state.
+    */
+    void ReloadLayer(LayerId layer_id, const std::string& fullfilename);
+
+    /// Returns read access to a layer. If the layer does not exist, an IniException is thrown.
+    const IniBuffer& GetLayer(LayerId layer_id) const;
+
+    /// Returns the number of layers in the stack.
+    size_t GetLayerCount() const noexcept;
+
+    /// Returns the layer which provides the resolved value. If the key is not present in any layer, an IniException is thrown.
+    LayerId GetSourceLayer(const std::string& section_name, const std::string& key_name) const;
+
+    /// Checks if any layer contains the requested key.
+    bool HasValue(const std::string& section_name, const std::string& key_name) const noexcept;
+
+    /** Receive a requested value from the top most layer containing it.
+    *
+    *   @details
+    *   The requested data member is automatically casted to the requested type.
+    *   @n If the key is not present in any layer or the requested type is inconsistent with the value, an IniException is thrown.
+    *
+    *   @param_t ValueT The type of the requested data member. Supported are {int, float, std::string, bool}
+    */
+    template<typename ValueT>
+    ValueT GetValue(const std::string& section_name, const std::string& key_name) const;
+
+    /** Receive a reference to a stored string value from the top most layer containing it, without copying it.
+    *
+    *   @details
+    *   The reference stays valid until the providing layer is replaced, reloaded or the stack is cleared.
+    */
+    const std::string& GetStringRef(const std::string& section_name, const std::string& key_name) const;
+
+    /// Removes all layers from the stack.
+    void Clear() noexcept;
+
+    // End of public IniStack interface
+    //===================================================================================
+
+    private:
+
+    /// Data type alias of a stored value inside a layer.
+    using Value_t = IniBuffer::Section::StringifiedValue;
+
+    static_assert(IniBuffer::StoragePolicy_t::stable_references, "The resolution index points into the layers, their storage must not move values.");
+
+    /// Entry of the resolution index. Points directly into the layer which provides the value.
+    /// The layers are never modified in place, so the pointer stays valid until its layer is replaced.
+    struct ResolvedValue
+    {
+        LayerId layer_id;
+        const Value_t* value;
+    };
+
+    /// Data type alias for the resolved keys of one section [key_name | resolved_value].
+    using KeyIndex_t = std::map<std::string, ResolvedValue>;
+
+    /// Data type alias for the resolution index [section_name | resolved_keys].
+    using ResolutionIndex_t = std::map<std::string, KeyIndex_t>;
+
+    /// Change of one entry of the resolution index. The names point into a layer, a resolved value of nullptr erases the entry.
+    struct IndexUpdate
+    {
+        const std::string* section_name;
+        const std::string* key_name;
+        ResolvedValue resolved;
+
+        /// Entry in the index which receives the resolved value. Set by ApplyUpdates.
+        ResolvedValue* entry;
+
+        /// Set if ApplyUpdates inserted the entry, which is removed again if a later insertion fails.
+        bool is_inserted;
+    };
+
+    /// Looks up a resolved value. Returns nullptr if the key is not present in any layer.
+    const ResolvedValue* Find(const std::string& section_name, const std::string& key_name) const noexcept;
+
+    /// Resolves all keys contained in a buffer again and appends the updates of their entries.
+    void ResolveKeysOf(const IniBuffer& buffer, std::vector<IndexUpdate>& updates) const;
+
+    /// Searches the layers from top to bottom for a key and appends the update of its entry.
+    void Resolve(const std::string& section_name, const std::string& key_name, std::vector<IndexUpdate>& updates) const;
+
+    /** Applies updates to the index in place.
+    *
+    *   @details
+    *   First the entries of all resolved values are inserted, which is the only step which may throw.
+    *   @n If it fails, the inserted entries are removed again and the index keeps its previous state.
+    *   @n Afterwards the values are assigned and the entries of removed keys are erased, which does not throw.
+    */
+    void ApplyUpdates(std::vector<IndexUpdate>& updates);
+
+    /// The layers ordered by precedence. The last one has the highest precedence.
+    std::vector<std::unique_ptr<IniBuffer>> layers_;
+
+    /// Merged view of all layers.
+    ResolutionIndex_t index_;
+};
+
+//===================================================================================
+// Implementation
+
+IniStack::LayerId IniStack::PushLayer(IniBuffer layer)
+{
+    const LayerId layer_id = layers_.size();
+    layers_.push_back(std::unique_ptr<IniBuffer>(new IniBuffer(std::move(layer))));
+
+    // The new layer is on top, its keys are resolved to itself without searching.
+    // The layer is removed again if the index can not be updated, so the index never points into a layer which is not part of the stack.
+    try
+    {
+        std::vector<IndexUpdate> updates;
+        for(const auto& section : layers_.back()->sections_)
+        {
+            for(const auto& property : section.second.properties_)
+            {
+                updates.push_back(IndexUpdate{&section.first, &property.first, ResolvedValue{layer_id, &property.second}, nullptr, false});
+            }
+        }
+        ApplyUpdates(updates);
+    }
+    catch(...)
+    {
+        layers_.pop_back();
+        throw;
+    }
+    return layer_id;
+}
+
+void IniStack::ReplaceLayer(LayerId layer_id, IniBuffer layer)
+{
+    if(layer_id >= layers_.size())
+    {
+        throw INI_EXCEPTION("Requested layer is not present in the stack. Layer: " + std::to_string(layer_id));
+    }
+
+    std::unique_ptr<IniBuffer> old_layer(new IniBuffer(std::move(layer)));
+    layers_[layer_id].swap(old_layer);
+
+    // Keys which disappeared fall back to lower layers, new keys may shadow them.
+    // Only the affected entries are updated. The old layer is restored if resolving or updating fails.
+    try
+    {
+        std::vector<IndexUpdate> updates;
+        ResolveKeysOf(*old_layer, updates);
+        ResolveKeysOf(*layers_[layer_id], updates);
+        ApplyUpdates(updates);
+    }
+    catch(...)
+    {
+        layers_[layer_id].swap(old_layer);
+        throw;
+    }
+}
+
+void IniStack::ReloadLayer(LayerId layer_id, const std::string& fullfilename)
+{
+    IniBuffer layer;
+    layer.LoadFile(fullfilename);
+    ReplaceLayer(layer_id, std::move(layer));
+}
+
+const IniBuffer& IniStack::GetLayer(LayerId layer_id) const
+{
+    if(layer_id >= layers_.size())
+    {
+        throw INI_EXCEPTION("Requested layer is not present in the stack. Layer: " + std::to_string(layer_id));
+    }
+    return *layers_[layer_id];
+}
+
+size_t IniStack::GetLayerCount() const noexcept
+{
+    return layers_.size();
+}
+
+IniStack::LayerId IniStack::GetSourceLayer(const std::string& section_name, const std::string& key_name) const
+{
+    const ResolvedValue* resolved = Find(section_name, key_name);
+    if(resolved == nullptr)
+    {
+        throw INI_EXCEPTION("Requested key is not present in any layer. Section: " + section_name + "; Key: " + key_name);
+    }
+    return resolved->layer_id;
+}
+
+bool IniStack::HasValue(const std::string& section_name, const std::string& key_name) const noexcept
+{
+    return Find(section_name, key_name) != nullptr;
+}
+
+template<typename ValueT>
+ValueT IniStack::GetValue(const std::string& section_name, const std::string& key_name) const
+{
+    const ResolvedValue* resolved = Find(section_name, key_name);
+    if(resolved == nullptr)
+    {
+        throw INI_EXCEPTION("Requested key is not present in any layer. Section: " + section_name + "; Key: " + key_name);
+    }
+    return resolved->value->GetValue<ValueT>();
+}
+
+const std::string& IniStack::GetStringRef(const std::string& section_name, const std::string& key_name) const
+{
+    const ResolvedValue* resolved = Find(section_name, key_name);
+    if(resolved == nullptr)
+    {
+        throw INI_EXCEPTION("Requested key is not present in any layer. Section: " + section_name + "; Key: " + key_name);
+    }
+    return resolved->value->GetStringRef();
+}
+
+void IniStack::Clear() noexcept
+{
+    index_.clear();
+    layers_.clear();
+    LOG("Cleared IniStack.");
+}
+
+const IniStack::ResolvedValue* IniStack::Find(const std::string& section_name, const std::string& key_name) const noexcept
+{
+    auto section = index_.find(section_name);
+    if(section == index_.end())
+    {
+        return nullptr;
+    }
+
+    auto key = section->second.find(key_name);
+    if(key == section->second.end())
+    {
+        return nullptr;
+    }
+    return &key->second;
+}
+
+void IniStack::ResolveKeysOf(const IniBuffer& buffer, std::vector<IndexUpdate>& updates) const
+{
+    for(const auto& section : buffer.sections_)
+    {
+        for(const auto& property : section.second.properties_)
+        {
+            Resolve(section.first, property.first, updates);
+        }
+    }
+}
+
+void IniStack::Resolve(const std::string& section_name, const std::string& key_name, std::vector<IndexUpdate>& updates) const
+{
+    for(LayerId layer_id = layers_.size(); layer_id-- > 0;)
+    {
+        const IniBuffer::SectionMap_t& sections = layers_[layer_id]->sections_;
+        auto section = sections.find(section_name);
+        if(section == sections.end())
+        {
+            continue;
+        }
+
+        auto property = section->second.properties_.find(key_name);
+        if(property != section->second.properties_.end())
+        {
+            updates.push_back(IndexUpdate{&section_name, &key_name, ResolvedValue{layer_id, &property->second}, nullptr, false});
+            return;
+        }
+    }
+
+    // Not present in any layer anymore.
+    updates.push_back(IndexUpdate{&section_name, &key_name, ResolvedValue{0, nullptr}, nullptr, false});
+}
+
+void IniStack::ApplyUpdates(std::vector<IndexUpdate>& updates)
+{
+    size_t prepared_count = 0;
+    try
+    {
+        for(; prepared_count < updates.size(); ++prepared_count)
+        {
+            IndexUpdate& update = updates[prepared_count];
+            if(update.resolved.value != nullptr)
+            {
+                auto entry = index_[*update.section_name].emplace(*update.key_name, update.resolved);
+                update.entry = &entry.first->second;
+                update.is_inserted = entry.second;
+            }
+        }
+    }
+    catch(...)
+    {
+        // Sections without keys are not part of the index, so emptied sections were inserted as well.
+        for(size_t i = 0; i <= prepared_count && i < updates.size(); ++i)
+        {
+            auto section = index_.find(*updates[i].section_name);
+            if(section == index_.end())
+            {
+                continue;
+            }
+            if(updates[i].is_inserted)
+            {
+                section->second.erase(*updates[i].key_name);
+            }
+            if(section->second.empty())
+            {
+                index_.erase(section);
+            }
+        }
+        throw;
+    }
+
+    for(IndexUpdate& update : updates)
+    {
+        if(update.resolved.value != nullptr)
+        {
+            *update.entry = update.resolved;
+            continue;
+        }
+
+        auto section = index_.find(*update.section_name);
+        if(section != index_.end())
+        {
+            section->second.erase(*update.key_name);
+            if(section->second.empty())
+            {
+                index_.erase(section);
+            }
+        }
+    }
+}
+#endif
@@ -0,0 +1,250 @@
+/**
+ * @file ini_storage.h
+ * @author Pascal Enderli
+ * @date 2026.10.18
+ * @brief Storage policies selecting the containers of a BasicIniBuffer.
+ */
+
+#ifndef INI_STORAGE_H_
+#define INI_STORAGE_H_
+
+#include<algorithm>
+#include<functional>
+#include<map>
+#include<memory>
+#include<stdexcept>
+#include<unordered_map>
+#include<utility>
+#include<vector>
+
+/// Namespace for internal functions which are used by the IniBuffer Class.
+namespace internal
+{
+    /** Map which stores its items in a vector sorted by key.
+    *
+    *   @details
+    *   Provides the subset of the std::map interface used by the IniBuffer. Lookups are binary searches
+    *   @n on contiguous memory. Insertions and erasures move the following items and invalidate
+    *   @n all references and iterators into the map.
+    */
+    template<typename KeyT, typename ValueT, typename AllocatorT>
+    class SortedVectorMap
+    {
+        public:
+
+        using value_type = std::pair<KeyT, ValueT>;
+        using Vector_t = std::vector<value_type, typename std::allocator_traits<AllocatorT>::template rebind_alloc<value_type>>;
+        using iterator = typename Vector_t::iterator;
+        using const_iterator = typename Vector_t::const_iterator;
+
+        iterator begin() noexcept {return items_.begin();}
+        iterator end() noexcept {return items_.end();}
+        const_iterator begin() const noexcept {return items_.begin();}
+        const_iterator end() const noexcept {return items_.end();}
+
+        size_t size() const noexcept {return items_.size();}
+        bool empty() const noexcept {return items_.empty();}
+        void clear() noexcept {items_.clear();}
+        void swap(SortedVectorMap& other) noexcept {items_.swap(other.items_);}
+
+        /// Returns the item with the given key or end().
+        iterator find(const KeyT& key);
+        const_iterator find(const KeyT& key) const;
+
+        /// Returns 1 if the key is present, otherwise 0.
+        size_t count(const KeyT& key) const;
+
+        /// Returns the value of a key. Throws std::out_of_range if the key is not present.
+        ValueT& at(const KeyT& key);
+        const ValueT& at(const KeyT& key) const;
+
+        /// Returns the value of a key. A default constructed value is inserted if the key is not present.
+        ValueT& operator[](const KeyT& key);
+
+        /// Inserts an item unless the key is present. Returns the item with the key and whether it was inserted.
+        std::pair<iterator, bool> emplace(const KeyT& key, const ValueT& value);
+
+        /// Removes the item with the given key. Returns the number of removed items.
+        size_t erase(const KeyT& key);
+
+        /// Removes an item. Returns the following item.
+        iterator erase(const_iterator position);
+
+        private:
+
+        /// Returns the first item whose key is not less than the given key.
+        iterator LowerBound(const KeyT& key);
+        const_iterator LowerBound(const KeyT& key) const;
+
+        /// Items sorted by key.
+        Vector_t items_;
+    };
+}
+
+/** Stores sections and properties in std::map.
+*
+*   @details
+*   Content is written sorted by name. References to values stay valid until the value is erased.
+*/
+struct OrderedStorage
+{
+    template<typename KeyT, typename ValueT, typename AllocatorT>
+    using Map_t = std::map<KeyT, ValueT, std::less<KeyT>, typename std::allocator_traits<AllocatorT>::template rebind_alloc<std::pair<const KeyT, ValueT>>>;
+
+    /// Estimated heap memory per item besides the item itself: three pointers and a color per tree node.
+    static constexpr size_t node_overhead = 4*sizeof(void*);
+
+    /// Adding items does not move the stored ones.
+    static constexpr bool stable_references = true;
+};
+
+/** Stores sections and properties in std::unordered_map.
+*
+*   @details
+*   Lookups hash the name instead of comparing it several times. Content is written in an unspecified order.
+*   @n References to values stay valid until the value is erased.
+*/
+struct HashedStorage
+{
+    template<typename KeyT, typename ValueT, typename AllocatorT>
+    using Map_t = std::unordered_map<KeyT, ValueT, std::hash<KeyT>, std::equal_to<KeyT>, typename std::allocator_traits<AllocatorT>::template rebind_alloc<std::pair<const KeyT, ValueT>>>;
+
+    /// Estimated heap memory per item besides the item itself: the node link, the cached hash and a bucket.
+    static constexpr size_t node_overhead = 3*sizeof(void*);
+
+    /// Adding items does not move the stored ones. Rehashing only relinks the nodes.
+    static constexpr bool stable_references = true;
+};
+
+/** Stores sections and properties in vectors sorted by name.
+*
+*   @details
+*   Content is written sorted by name. Compact and fast to read, but every insertion moves the following items.
+*   @n Adding a section or a property invalidates references returned by GetStringRef.
+*/
+struct SortedVectorStorage
+{
+    template<typename KeyT, typename ValueT, typename AllocatorT>
+    using Map_t = internal::SortedVectorMap<KeyT, ValueT, AllocatorT>;
+
+    /// Items are stored without any node.
+    static constexpr size_t node_overhead = 0;
+
+    /// Adding items moves the stored ones.
+    static constexpr bool stable_references = false;
+};
+
+//===================================================================================
+// Implementation
+
+constexpr size_t OrderedStorage::node_overhead;
+constexpr size_t HashedStorage::node_overhead;
+constexpr size_t SortedVectorStorage::node_overhead;
+constexpr bool OrderedStorage::stable_references;
+constexpr bool HashedStorage::stable_references;
+constexpr bool SortedVectorStorage::stable_references;
+
+namespace internal
+{
+    template<typename KeyT, typename ValueT, typename AllocatorT>
+    typename SortedVectorMap<KeyT, ValueT, AllocatorT>::iterator SortedVectorMap<KeyT, ValueT, AllocatorT>::find(const KeyT& key)
+    {
+        iterator item = LowerBound(key);
+        return (item != items_.end() && item->first == key) ? item : items_.end();
+    }
+
+    template<typename KeyT, typename ValueT, typename AllocatorT>
+    typename SortedVectorMap<KeyT, ValueT, AllocatorT>::const_iterator SortedVectorMap<KeyT, ValueT, AllocatorT>::find(const KeyT& key) const
+    {
+        const_iterator item = LowerBound(key);
+        return (item != items_.end() && item->first == key) ? item : items_.end();
+    }
+
+    template<typename KeyT, typename ValueT, typename AllocatorT>
+    size_t SortedVectorMap<KeyT, ValueT, AllocatorT>::count(const KeyT& key) const
+    {
+        return find(key) != items_.end() ? 1 : 0;
+    }
+
+    template<typename KeyT, typename ValueT, typename AllocatorT>
+    ValueT& SortedVectorMap<KeyT, ValueT, AllocatorT>::at(const KeyT& key)
+    {
+        iterator item = find(key);
+        if(item == items_.end())
+        {
+            throw std::out_of_range("SortedVectorMap::at: key is not present.");
+        }
+        return item->second;
+    }
+
+    template<typename KeyT, typename ValueT, typename AllocatorT>
+    const ValueT& SortedVectorMap<KeyT, ValueT, AllocatorT>::at(const KeyT& key) const
+    {
+        const_iterator item = find(key);
+        if(item == items_.end())
+        {
+            throw std::out_of_range("SortedVectorMap::at: key is not present.");
+        }
+        return item->second;
+    }
+
+    template<typename KeyT, typename ValueT, typename AllocatorT>
+    ValueT& SortedVectorMap<KeyT, ValueT, AllocatorT>::operator[](const KeyT& key)
+    {
+        iterator item = LowerBound(key);
+        if(item == items_.end() || item->first != key)
+        {
+            item = items_.insert(item, value_type(key, ValueT()));
+        }
+        return item->second;
+    }
+
+    template<typename KeyT, typename ValueT, typename AllocatorT>
+    std::pair<typename SortedVectorMap<KeyT, ValueT, AllocatorT>::iterator, bool> SortedVectorMap<KeyT, ValueT, AllocatorT>::emplace(const KeyT& key, const ValueT& value)
+    {
+        iterator item = LowerBound(key);
+        if(item != items_.end() && item->first == key)
+        {
+            return std::make_pair(item, false);
+        }
+        return std::make_pair(items_.insert(item, value_type(key, value)), true);
+    }
+
+    template<typename KeyT, typename ValueT, typename AllocatorT>
+    size_t SortedVectorMap<KeyT, ValueT, AllocatorT>::erase(const KeyT& key)
+    {
+        iterator item = find(key);
+        if(item == items_.end())
+        {
+            return 0;
+        }
+        items_.erase(item);
+        return 1;
+    }
+
+    template<typename KeyT, typename ValueT, typename AllocatorT>
+    typename SortedVectorMap<KeyT, ValueT, AllocatorT>::iterator SortedVectorMap<KeyT, ValueT, AllocatorT>::erase(const_iterator position)
+    {
+        // Converts to a mutable iterator, vector::erase(const_iterator) is not available in older standard libraries.
+        return items_.erase(items_.begin() + (position - items_.cbegin()));
+    }
+
+    template<typename KeyT, typename ValueT, typename AllocatorT>
+    typename SortedVectorMap<KeyT, ValueT, AllocatorT>::iterator SortedVectorMap<KeyT, ValueT, AllocatorT>::LowerBound(const KeyT& key)
+    {
+        return std::lower_bound(items_.begin(), items_.end(), key, [](const value_type& item, const KeyT& key)
+        {
+            return item.first < key;
+        });
+    }
+
+    template<typename KeyT, typename ValueT, typename AllocatorT>
+    typename SortedVectorMap<KeyT, ValueT, AllocatorT>::const_iterator SortedVectorMap<KeyT, ValueT, AllocatorT>::LowerBound(const KeyT& key) const
+    {
+        return std::lower_bound(items_.begin(), items_.end(), key, [](const value_type& item, const KeyT& key)
+        {
+            return item.first < key;
+        });
+    }
+}
+#endif
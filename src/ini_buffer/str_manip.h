@@ -10,47 +10,110 @@
 
 #include<algorithm>
 #include<cctype>
+#include<cstring>
 #include<stdio.h>
 #include<string>
 #include<time.h>
 
-/// Trims white spaces to the left of a string.
-static void LTrim(std::string& s) noexcept
+/** Non owning read only view on a sequence of characters.
+*
+*   @details
+*   The viewed characters must outlive the view. The sequence does not need to be null terminated.
+*/
+class StringView
 {
-    s.erase(s.begin(), std::find_if(s.begin(), s.end(),
-    [](int ch){ return !std::isspace(ch);}
-    ));
-}
+    public:
 
-/// Trims white spaces to the right of a string.
-static void RTrim(std::string& s) noexcept
-{
-    s.erase(std::find_if(s.rbegin(), s.rend(),
-    [](int ch) { return !std::isspace(ch);}
-    ).base(), s.end());
-}
+    /// Position returned if nothing was found.
+    static constexpr size_t npos = std::string::npos;
+
+    /// Constructs an empty view.
+    StringView() noexcept : data_(""), size_(0) {}
+
+    /// Constructs a view on a character sequence with a given length.
+    StringView(const char* data, size_t size) noexcept : data_(data), size_(size) {}
+
+    /// Constructs a view on the content of a std::string.
+    StringView(const std::string& str) noexcept : data_(str.data()), size_(str.size()) {}
+
+    /// Returns a pointer to the first character. The sequence is not null terminated.
+    const char* data() const noexcept {return data_;}
 
-/// Trims white spaces on both ends of a string.
-static void TrimWhitespace(std::string& s) noexcept
+    /// Returns the number of characters.
+    size_t size() const noexcept {return size_;}
+
+    /// Checks if the view contains no characters.
+    bool empty() const noexcept {return size_ == 0;}
+
+    /// Returns the character at a position. The position is not checked.
+    char operator[](size_t pos) const noexcept {return data_[pos];}
+
+    /// Returns a view on a part of this view. The range is clamped to the size of this view.
+    StringView substr(size_t pos, size_t count = npos) const noexcept
+    {
+        pos = std::min(pos, size_);
+        return StringView(data_ + pos, std::min(count, size_ - pos));
+    }
+
+    /// Returns the position of the first character equal to ch or npos.
+    size_t find(char ch) const noexcept
+    {
+        const void* found = size_ == 0 ? nullptr : std::memchr(data_, ch, size_);
+        return found == nullptr ? npos : static_cast<const char*>(found) - data_;
+    }
+
+    /// Returns the position of the first character equal to one of the characters in chars or npos.
+    size_t find_first_of(const char* chars) const noexcept
+    {
+        for(size_t pos = 0; pos < size_; ++pos)
+        {
+            for(const char* ch = chars; *ch != '\0'; ++ch)
+            {
+                if(data_[pos] == *ch)
+                {
+                    return pos;
+                }
+            }
+        }
+        return npos;
+    }
+
+    /// Checks if the view starts with a given null terminated prefix.
+    bool starts_with(const char* prefix) const noexcept
+    {
+        const size_t length = std::strlen(prefix);
+        return length <= size_ && std::memcmp(data_, prefix, length) == 0;
+    }
+
+    /// Copies the viewed characters into a std::string.
+    std::string ToString() const {return std::string(data_, size_);}
+
+    private:
+
+    const char* data_;
+    size_t size_;
+};
+
+/// Checks if a character is a white space in the "C" locale. Faster than std::isspace, which consults the current locale.
+static inline bool IsWhitespace(char ch) noexcept
 {
-    LTrim(s);
-    RTrim(s);
+    return ch == ' ' || (ch >= '\t' && ch <= '\r');
 }
 
-/// Cuts away the comments on the right end of a line delimited with a '#' or a ';'
-static void TrimComment(std::string& s) noexcept
+/// Trims white spaces on both ends of a string view.
+static void TrimWhitespace(StringView& s) noexcept
 {
-    size_t pos = s.find_first_of(";#");
-    if(pos != std::string::npos)
-    {
-        s.erase(pos,  std::string::npos);
-    }
+    size_t begin = 0;
+    size_t end = s.size();
+    while(begin < end && IsWhitespace(s[begin])){++begin;}
+    while(end > begin && IsWhitespace(s[end - 1])){--end;}
+    s = s.substr(begin, end - begin);
 }
 
-/// Checks if a string contains white spaces.
-static bool ContainsWhiteSpace(const std::string& str) noexcept
+/// Checks if a string view contains white spaces.
+static bool ContainsWhiteSpace(const StringView& str) noexcept
 {
-    return str.find(" ") != std::string::npos;
+    return str.find(' ') != StringView::npos;
 }
 
 #endif
@@ -2049,7 +2049,30 @@ inline function get_type_overload(const void *this_ptr, const detail::type_info
 
     /* Don't call dispatch code if invoked from overridden function.
        Unfortunately this doesn't work on PyPy. */
-#if !defined(PYPY_VERSION)
+#if !defined(PYPY_VERSION) && PY_VERSION_HEX >= 0x03090000
+    PyFrameObject *frame = PyThreadState_GetFrame(PyThreadState_Get());
+    if (frame) {
+        PyCodeObject *f_code = PyFrame_GetCode(frame);
+        bool is_self_caller = false;
+        if ((std::string) str(f_code->co_name) == name && f_code->co_argcount > 0) {
+            PyObject *locals = PyEval_GetLocals();
+#if PY_VERSION_HEX >= 0x030b0000
+            PyObject *co_varnames = PyCode_GetVarnames(f_code);
+#else
+            PyObject *co_varnames = PyObject_GetAttrString((PyObject *) f_code, "co_varnames");
+#endif
+            if (locals && co_varnames) {
+                PyObject *self_caller = PyDict_GetItem(locals, PyTuple_GET_ITEM(co_varnames, 0));
+                is_self_caller = self_caller == self.ptr();
+            }
+            Py_XDECREF(co_varnames);
+        }
+        Py_DECREF(f_code);
+        Py_DECREF(frame);
+        if (is_self_caller)
+            return function();
+    }
+#elif !defined(PYPY_VERSION)
     PyFrameObject *frame = PyThreadState_Get()->frame;
     if (frame && (std::string) str(frame->f_code->co_name) == name &&
         frame->f_code->co_argcount > 0) {
@@ -8,6 +8,12 @@
 #ifndef INI_BUFFER_PY_H_
 #define INI_BUFFER_PY_H_
 
+#include<cerrno>
+#include<cmath>
+#include<cstdio>
+#include<cstdlib>
+#include<cstring>
+#include<vector>
 #include<pybind11/pybind11.h>
 #include"ini_buffer.h"
 
@@ -18,7 +24,7 @@ namespace py = pybind11;
 //------------------------------------------------------------------------------
 // Cast Value
 template<>
-py::str IniBuffer::Section::StringifiedValue::CastValue<py::str>() const
+py::str IniBufferBase::StringifiedValue::CastValue<py::str>() const
 {
     if(type_ == DataType::STRING)
     {
@@ -31,7 +37,7 @@ py::str IniBuffer::Section::StringifiedValue::CastValue<py::str>() const
 }
 
 template<>
-py::int_ IniBuffer::Section::StringifiedValue::CastValue<py::int_>() const
+py::int_ IniBufferBase::StringifiedValue::CastValue<py::int_>() const
 {
     try
     {
@@ -52,7 +58,7 @@ py::int_ IniBuffer::Section::StringifiedValue::CastValue<py::int_>() const
 }
 
 template<>
-py::float_ IniBuffer::Section::StringifiedValue::CastValue<py::float_>() const
+py::float_ IniBufferBase::StringifiedValue::CastValue<py::float_>() const
 {
     try
     {
@@ -73,7 +79,7 @@ py::float_ IniBuffer::Section::StringifiedValue::CastValue<py::float_>() const
 }
 
 template<>
-py::bool_ IniBuffer::Section::StringifiedValue::CastValue<py::bool_>() const
+py::bool_ IniBufferBase::StringifiedValue::CastValue<py::bool_>() const
 {
     try
     {
@@ -104,14 +110,53 @@ py::bool_ IniBuffer::Section::StringifiedValue::CastValue<py::bool_>() const
 //-----------------------------------------------------------------------------
 // Stringify
 
+/** Formats a float with all the digits needed to read back the same value.
+*
+*   @details
+*   The result always contains a decimal point and never an exponent, so it is detected as float when loading.
+*/
+std::string FormatDouble(double number)
+{
+    if(!std::isfinite(number))
+    {
+        throw INI_EXCEPTION("Non finite values can not be stored: " + std::to_string(number));
+    }
+
+    char digits[400];
+    std::snprintf(digits, sizeof(digits), "%.15g", number);
+    if(std::strtod(digits, nullptr) != number)
+    {
+        std::snprintf(digits, sizeof(digits), "%.17g", number);
+    }
+
+    std::string formatted(digits);
+    if(formatted.find_first_of("eE") != std::string::npos)
+    {
+        // Very small numbers need digits beyond the leading zeros, large ones are integral.
+        const int exponent = static_cast<int>(std::floor(std::log10(std::fabs(number))));
+        std::snprintf(digits, sizeof(digits), "%.*f", exponent < 0 ? 17 - exponent : 1, number);
+        formatted = digits;
+        formatted.erase(formatted.find_last_not_of('0') + 1);
+    }
+    if(formatted.find('.') == std::string::npos)
+    {
+        formatted += ".0";
+    }
+    else if(formatted.back() == '.')
+    {
+        formatted += '0';
+    }
+    return formatted;
+}
+
 template<>
-std::string IniBuffer::Stringify<py::str>(const py::str& value) const
+std::string IniBufferBase::Stringify<py::str>(const py::str& value)
 {
     return value.cast<std::string>();
 }
 
 template<>
-std::string IniBuffer::Stringify<py::int_>(const py::int_& value) const
+std::string IniBufferBase::Stringify<py::int_>(const py::int_& value)
 {
 
     try
@@ -124,19 +169,18 @@ std::string IniBuffer::Stringify<py::int_>(const py::int_& value) const
 }
 
 template<>
-std::string IniBuffer::Stringify<py::float_>(const py::float_& value) const
+std::string IniBufferBase::Stringify<py::float_>(const py::float_& value)
 {
     try
     {
-        float number = value.cast<float>();
-    	return std::to_string(number);
+        return FormatDouble(value.cast<double>());
     }
     catch(const std::length_error& e){throw INI_EXCEPTION("Stringified value is too long. length_error: "+std::string(e.what()));}
     catch(std::bad_alloc& e){throw INI_EXCEPTION("String bad_alloc: "+std::string(e.what()));}
 }
 
 template<>
-std::string IniBuffer::Stringify<py::bool_>(const py::bool_& value) const
+std::string IniBufferBase::Stringify<py::bool_>(const py::bool_& value)
 {
 	bool val = value.cast<bool>();
     if(val==true)
@@ -149,4 +193,542 @@ std::string IniBuffer::Stringify<py::bool_>(const py::bool_& value) const
     }
 }
 
+//-----------------------------------------------------------------------------
+// Native python objects
+
+/** Converts a stored value to a natively typed python object using its auto detected type.
+*
+*   @details
+*   Ints become int, floats float, bools bool and strings str. Empty values become None.
+*   @n Values which can not be converted to their detected type are returned as str.
+*/
+py::object ToPython(const std::string& value, IniBuffer::DataType type)
+{
+    switch(type)
+    {
+        case IniBuffer::DataType::INT:
+        {
+            // Python ints have arbitrary precision, so no range check is needed.
+            PyObject* number = PyLong_FromString(value.c_str(), nullptr, 10);
+            if(number != nullptr)
+            {
+                return py::reinterpret_steal<py::object>(number);
+            }
+            PyErr_Clear();
+            break;
+        }
+        case IniBuffer::DataType::FLOAT:
+        {
+            char* end = nullptr;
+            double number = std::strtod(value.c_str(), &end);
+            if(end != value.c_str())
+            {
+                return py::float_(number);
+            }
+            break;
+        }
+        case IniBuffer::DataType::BOOL:
+            return py::bool_(0 == value.compare("true") || 0 == value.compare("TRUE") || 0 == value.compare("True"));
+        case IniBuffer::DataType::EMPTY:
+            return py::none();
+        default:
+            break;
+    }
+    return py::str(value);
+}
+
+/// Converts all properties of a section into a dict [key_name | native value]. Throws an IniException if the section is not present.
+py::dict SectionToDict(const IniBuffer& ini, const std::string& section_name)
+{
+    py::dict properties;
+    ini.ForEachProperty(section_name, [&properties](const std::string& key_name, const std::string& value, IniBuffer::DataType type)
+    {
+        properties[py::str(key_name)] = ToPython(value, type);
+    });
+    return properties;
+}
+
+/// Returns a value as natively typed python object. Throws an IniException if the value is not present.
+py::object GetNative(const IniBuffer& ini, const std::string& section_name, const std::string& key_name)
+{
+    IniBuffer::DataType type;
+    const std::string* value = ini.FindStoredValue(section_name, key_name, type);
+    if(value == nullptr)
+    {
+        throw INI_EXCEPTION("Requested key is not present in the data structure. Section: " + section_name + "; Key: " + key_name);
+    }
+    return ToPython(*value, type);
+}
+
+/** Stores a python value. The type is dispatched once instead of trying an overload per type.
+*
+*   @details
+*   Ints are stored with all their digits, floats with all digits needed to read back the same value (see FormatDouble).
+*   @n Other types raise a TypeError.
+*/
+void SetNative(IniBuffer& ini, const std::string& section_name, const std::string& key_name, const py::handle& value)
+{
+    // bool is a subclass of int, so it is tested first.
+    if(PyBool_Check(value.ptr()))
+    {
+        ini.AddValue(section_name, key_name, value.ptr() == Py_True);
+    }
+    else if(PyLong_Check(value.ptr()))
+    {
+        ini.AddValue(section_name, key_name, static_cast<std::string>(py::str(value)));
+    }
+    else if(PyFloat_Check(value.ptr()))
+    {
+        ini.AddValue(section_name, key_name, FormatDouble(PyFloat_AS_DOUBLE(value.ptr())));
+    }
+    else if(PyUnicode_Check(value.ptr()))
+    {
+        ini.AddValue(section_name, key_name, value.cast<std::string>());
+    }
+    else
+    {
+        throw py::type_error("Unsupported value type: " + static_cast<std::string>(py::str(value.get_type())) + ". Supported are int, float, bool and str.");
+    }
+}
+
+/// Assigns a python str to a std::string. Reuses the capacity of the string. Other types raise a TypeError.
+void AssignString(const py::handle& str, std::string& output)
+{
+    Py_ssize_t size = 0;
+    const char* data = PyUnicode_Check(str.ptr()) ? PyUnicode_AsUTF8AndSize(str.ptr(), &size) : nullptr;
+    if(data == nullptr)
+    {
+        PyErr_Clear();
+        throw py::type_error("Section and key names must be of type str.");
+    }
+    output.assign(data, static_cast<size_t>(size));
+}
+
+//-----------------------------------------------------------------------------
+// Loading and writing without the GIL
+//
+// Other Python threads may modify the same buffer while the GIL is released. Therefore content is parsed into a
+// local buffer and moved into the shared one after taking the GIL back, and files are written from a copy.
+
+/// Loads a file into a local buffer while the GIL is released. Its content is moved into ini with the GIL held.
+void LoadFile(IniBuffer& ini, const std::string& fullfilename)
+{
+    IniBuffer loaded;
+    {
+        py::gil_scoped_release release;
+        loaded.LoadFile(fullfilename);
+    }
+    ini.Adopt(std::move(loaded));
+}
+
+/// Parses the content of a buffer, e.g. bytes, bytearray or memoryview, without copying it. The GIL is released while parsing.
+void LoadBytes(IniBuffer& ini, const py::buffer& content, const std::string& base_directory)
+{
+    // The buffer_info keeps the content exported and thus unmodifiable until parsing is done.
+    py::buffer_info info = content.request();
+    if(info.ndim != 1 || info.itemsize != 1 || info.strides[0] != 1)
+    {
+        throw py::type_error("The content must be a contiguous buffer of bytes. Format: " + info.format);
+    }
+
+    IniBuffer loaded;
+    {
+        py::gil_scoped_release release;
+        loaded.LoadFromBuffer(static_cast<const char*>(info.ptr), static_cast<size_t>(info.size), base_directory);
+    }
+    ini.Adopt(std::move(loaded));
+}
+
+/// Parses the content of a str. Uses the UTF-8 representation cached by the str. The GIL is released while parsing.
+void LoadString(IniBuffer& ini, const py::str& content, const std::string& base_directory)
+{
+    Py_ssize_t size = 0;
+    const char* data = PyUnicode_AsUTF8AndSize(content.ptr(), &size);
+    if(data == nullptr)
+    {
+        throw py::error_already_set();
+    }
+
+    IniBuffer loaded;
+    {
+        py::gil_scoped_release release;
+        loaded.LoadFromBuffer(data, static_cast<size_t>(size), base_directory);
+    }
+    ini.Adopt(std::move(loaded));
+}
+
+/// Writes a copy of the buffer, which is taken with the GIL held. The GIL is released while formatting and writing.
+void WriteFile(const IniBuffer& ini, const std::string& fullfilename, bool with_header, size_t thread_count)
+{
+    std::unique_ptr<IniBuffer> snapshot(new IniBuffer(ini));
+    py::gil_scoped_release release;
+    snapshot->WriteFile(fullfilename, with_header, thread_count);
+    snapshot.reset();
+}
+
+/// Returns a value as natively typed python object, or default_value if it is not present.
+py::object GetNativeOrDefault(const IniBuffer& ini, const std::string& section_name, const std::string& key_name, const py::object& default_value)
+{
+    IniBuffer::DataType type;
+    const std::string* value = ini.FindStoredValue(section_name, key_name, type);
+    return value != nullptr ? ToPython(*value, type) : default_value;
+}
+
+/// Returns the values of several keys of one section as natively typed python objects. Missing keys are returned as default_value.
+py::list GetManyOfSection(const IniBuffer& ini, const std::string& section_name, const py::iterable& key_names, const py::object& default_value)
+{
+    py::list values;
+    std::string key_name;
+    for(const py::handle& name : key_names)
+    {
+        AssignString(name, key_name);
+        values.append(GetNativeOrDefault(ini, section_name, key_name, default_value));
+    }
+    return values;
+}
+
+/// Returns the values of several (section_name, key_name) pairs as natively typed python objects. Missing keys are returned as default_value.
+py::list GetMany(const IniBuffer& ini, const py::iterable& names, const py::object& default_value)
+{
+    py::list values;
+    std::string section_name;
+    std::string key_name;
+    for(const py::handle& name : names)
+    {
+        if(!PyTuple_Check(name.ptr()) || PyTuple_GET_SIZE(name.ptr()) != 2)
+        {
+            throw py::type_error("Names must be given as (section_name, key_name) tuples.");
+        }
+        AssignString(PyTuple_GET_ITEM(name.ptr(), 0), section_name);
+        AssignString(PyTuple_GET_ITEM(name.ptr(), 1), key_name);
+        values.append(GetNativeOrDefault(ini, section_name, key_name, default_value));
+    }
+    return values;
+}
+
+//-----------------------------------------------------------------------------
+// Mapping protocol
+
+/** Lazy view of one section, returned by ini[section_name].
+*
+*   @details
+*   Holds the buffer and the section name instead of a copy of the properties. Values are looked up and converted
+*   @n on access. The view stays usable when the section is erased and added again.
+*/
+struct SectionProxy
+{
+    IniBuffer* ini;
+    std::string section_name;
+};
+
+/// Returns a view of a section. Raises a KeyError if the section is not present.
+SectionProxy GetSectionProxy(IniBuffer& ini, const std::string& section_name)
+{
+    if(!ini.HasSection(section_name))
+    {
+        throw py::key_error(section_name);
+    }
+    return SectionProxy{&ini, section_name};
+}
+
+/// Erases a section. Raises a KeyError if the section is not present.
+void DeleteSection(IniBuffer& ini, const std::string& section_name)
+{
+    if(!ini.HasSection(section_name))
+    {
+        throw py::key_error(section_name);
+    }
+    ini.EraseSection(section_name);
+}
+
+/// Returns the names of all sections.
+py::list GetSectionNames(const IniBuffer& ini)
+{
+    py::list section_names;
+    ini.ForEachSection([&section_names](const std::string& section_name)
+    {
+        section_names.append(py::str(section_name));
+    });
+    return section_names;
+}
+
+/// Returns a value of the viewed section as natively typed python object. Raises a KeyError if it is not present.
+py::object GetProxyValue(const SectionProxy& proxy, const std::string& key_name)
+{
+    IniBuffer::DataType type;
+    const std::string* value = proxy.ini->FindStoredValue(proxy.section_name, key_name, type);
+    if(value == nullptr)
+    {
+        throw py::key_error(key_name);
+    }
+    return ToPython(*value, type);
+}
+
+/// Erases a property of the viewed section. Raises a KeyError if it is not present.
+void DeleteProxyValue(const SectionProxy& proxy, const std::string& key_name)
+{
+    IniBuffer::DataType type;
+    if(proxy.ini->FindStoredValue(proxy.section_name, key_name, type) == nullptr)
+    {
+        throw py::key_error(key_name);
+    }
+    proxy.ini->EraseProperty(proxy.section_name, key_name);
+}
+
+/// Checks if the viewed section contains a key.
+bool ProxyContains(const SectionProxy& proxy, const std::string& key_name)
+{
+    IniBuffer::DataType type;
+    return proxy.ini->FindStoredValue(proxy.section_name, key_name, type) != nullptr;
+}
+
+/// Returns the key names of the viewed section.
+py::list GetProxyKeys(const SectionProxy& proxy)
+{
+    py::list key_names;
+    proxy.ini->ForEachProperty(proxy.section_name, [&key_names](const std::string& key_name, const std::string&, IniBuffer::DataType)
+    {
+        key_names.append(py::str(key_name));
+    });
+    return key_names;
+}
+
+/// Returns (key_name, native value) tuples of the viewed section.
+py::list GetProxyItems(const SectionProxy& proxy)
+{
+    py::list items;
+    proxy.ini->ForEachProperty(proxy.section_name, [&items](const std::string& key_name, const std::string& value, IniBuffer::DataType type)
+    {
+        items.append(py::make_tuple(py::str(key_name), ToPython(value, type)));
+    });
+    return items;
+}
+
+/// Returns the number of properties of the viewed section.
+size_t GetProxyLength(const SectionProxy& proxy)
+{
+    size_t count = 0;
+    proxy.ini->ForEachProperty(proxy.section_name, [&count](const std::string&, const std::string&, IniBuffer::DataType){++count;});
+    return count;
+}
+
+//-----------------------------------------------------------------------------
+// Numeric arrays
+
+/// Checks if a key name matches a pattern with the wildcards * (any sequence) and ? (any character).
+bool MatchesPattern(const char* name, const char* pattern) noexcept
+{
+    const char* star = nullptr;
+    const char* star_name = nullptr;
+    while(*name != '\0')
+    {
+        if(*pattern == '*')
+        {
+            star = pattern++;
+            star_name = name;
+        }
+        else if(*pattern == '?' || *pattern == *name)
+        {
+            ++pattern;
+            ++name;
+        }
+        else if(star != nullptr)
+        {
+            pattern = star + 1;
+            name = ++star_name;
+        }
+        else
+        {
+            return false;
+        }
+    }
+    while(*pattern == '*')
+    {
+        ++pattern;
+    }
+    return *pattern == '\0';
+}
+
+/// Calls a function as function(key_name, value, type) for every int and float value of a section whose key matches a pattern.
+template<typename FunctionT>
+void ForEachNumber(const IniBuffer& ini, const std::string& section_name, const std::string& pattern, FunctionT function)
+{
+    ini.ForEachProperty(section_name, [&](const std::string& key_name, const std::string& value, IniBuffer::DataType type)
+    {
+        if((type == IniBuffer::DataType::INT || type == IniBuffer::DataType::FLOAT) && MatchesPattern(key_name.c_str(), pattern.c_str()))
+        {
+            function(key_name, value, type);
+        }
+    });
+}
+
+/// Returns the keys of the values exported by ExportArray, in the same order.
+py::list GetArrayKeys(const IniBuffer& ini, const std::string& section_name, const std::string& pattern)
+{
+    py::list key_names;
+    ForEachNumber(ini, section_name, pattern, [&key_names](const std::string& key_name, const std::string&, IniBuffer::DataType)
+    {
+        key_names.append(py::str(key_name));
+    });
+    return key_names;
+}
+
+/** Writes the int and float values of a section whose keys match a pattern into a writable one dimensional buffer.
+*
+*   @details
+*   The buffer must hold 64 bit floats or 64 bit ints, e.g. a numpy array of dtype float64 or int64, and have exactly
+*   @n one element per value. Floats can not be written to an int buffer. No python object is created per value.
+*   @n All values are converted before the first one is written, so the buffer is left untouched if the call fails.
+*   @n A buffer of the wrong length raises a ValueError.
+*
+*   @return The number of written values.
+*/
+size_t ExportArray(const IniBuffer& ini, const std::string& section_name, const py::buffer& out, const std::string& pattern)
+{
+    py::buffer_info info = out.request(true);
+    const bool is_float = info.format == "d";
+    const bool is_int = info.itemsize == 8 && (info.format == "q" || info.format == "l");
+    if(info.ndim != 1 || (!is_float && !is_int))
+    {
+        throw py::type_error("The output must be a one dimensional buffer of 64 bit floats or 64 bit ints. Format: " + info.format);
+    }
+
+    // Converted values in the layout of the output elements.
+    std::vector<double> floats;
+    std::vector<long long> ints;
+    ForEachNumber(ini, section_name, pattern, [&](const std::string& key_name, const std::string& value, IniBuffer::DataType type)
+    {
+        errno = 0;
+        if(is_float)
+        {
+            floats.push_back(std::strtod(value.c_str(), nullptr));
+        }
+        else
+        {
+            if(type != IniBuffer::DataType::INT)
+            {
+                throw INI_EXCEPTION("A float value can not be exported to an int array. Section: " + section_name + "; Key: " + key_name);
+            }
+            ints.push_back(std::strtoll(value.c_str(), nullptr, 10));
+        }
+        if(errno == ERANGE)
+        {
+            throw INI_EXCEPTION("Out Of Range: " + value + " Section: " + section_name + "; Key: " + key_name);
+        }
+    });
+
+    const size_t count = is_float ? floats.size() : ints.size();
+    if(count != static_cast<size_t>(info.shape[0]))
+    {
+        throw py::value_error("The output has " + std::to_string(info.shape[0]) + " elements, the section has " + std::to_string(count) + " matching values. Section: " + section_name);
+    }
+
+    const char* number = is_float ? reinterpret_cast<const char*>(floats.data()) : reinterpret_cast<const char*>(ints.data());
+    char* element = static_cast<char*>(info.ptr);
+    for(size_t i = 0; i < count; ++i)
+    {
+        std::memcpy(element, number, 8);
+        number += 8;
+        element += info.strides[0];
+    }
+    return count;
+}
+
+/// Creates a numpy array of a given dtype with the int and float values of a section. Requires numpy.
+py::object GetArray(const IniBuffer& ini, const std::string& section_name, const std::string& pattern, const std::string& dtype)
+{
+    size_t count = 0;
+    ForEachNumber(ini, section_name, pattern, [&count](const std::string&, const std::string&, IniBuffer::DataType){++count;});
+
+    py::object array = py::module::import("numpy").attr("empty")(count, dtype);
+    ExportArray(ini, section_name, array.cast<py::buffer>(), pattern);
+    return array;
+}
+
+/// Reads element i of a one dimensional buffer of numbers and stringifies it.
+std::string StringifyElement(const py::buffer_info& info, py::ssize_t i)
+{
+    const char* element = static_cast<const char*>(info.ptr) + i*info.strides[0];
+    const char format = info.format.size() == 1 ? info.format[0] : info.format.back();
+
+    #define INI_BUFFER_ELEMENT(type) [&element](){type number; std::memcpy(&number, element, sizeof(number)); return number;}()
+    switch(format)
+    {
+        case 'd': return FormatDouble(INI_BUFFER_ELEMENT(double));
+        case 'f': return FormatDouble(INI_BUFFER_ELEMENT(float));
+        case 'b': return std::to_string(INI_BUFFER_ELEMENT(signed char));
+        case 'B': return std::to_string(INI_BUFFER_ELEMENT(unsigned char));
+        case 'h': return std::to_string(INI_BUFFER_ELEMENT(short));
+        case 'H': return std::to_string(INI_BUFFER_ELEMENT(unsigned short));
+        case 'i': return std::to_string(INI_BUFFER_ELEMENT(int));
+        case 'I': return std::to_string(INI_BUFFER_ELEMENT(unsigned int));
+        case 'l': return std::to_string(INI_BUFFER_ELEMENT(long));
+        case 'L': return std::to_string(INI_BUFFER_ELEMENT(unsigned long));
+        case 'q': return std::to_string(INI_BUFFER_ELEMENT(long long));
+        case 'Q': return std::to_string(INI_BUFFER_ELEMENT(unsigned long long));
+        case '?': return INI_BUFFER_ELEMENT(bool) ? "true" : "false";
+        default: throw py::type_error("Unsupported element format of the values: " + info.format);
+    }
+    #undef INI_BUFFER_ELEMENT
+}
+
+/** Stores the elements of a one dimensional buffer of numbers, e.g. a numpy array, under the given keys of a section.
+*
+*   @details
+*   Floats are stored with all digits needed to read back the same value. All changes are reported as one batch.
+*/
+void ImportArray(IniBuffer& ini, const std::string& section_name, const py::iterable& key_names, const py::buffer& values)
+{
+    py::buffer_info info = values.request();
+    if(info.ndim != 1)
+    {
+        throw py::type_error("The values must be a one dimensional buffer.");
+    }
+
+    std::vector<std::string> names;
+    for(const py::handle& name : key_names)
+    {
+        names.emplace_back();
+        AssignString(name, names.back());
+    }
+    if(names.size() != static_cast<size_t>(info.shape[0]))
+    {
+        throw INI_EXCEPTION("Got " + std::to_string(names.size()) + " keys for " + std::to_string(info.shape[0]) + " values. Section: " + section_name);
+    }
+
+    // Everything is converted first, so an invalid element does not leave a partial import.
+    std::vector<std::string> stringified_values;
+    stringified_values.reserve(names.size());
+    for(py::ssize_t i = 0; i < info.shape[0]; ++i)
+    {
+        stringified_values.push_back(StringifyElement(info, i));
+    }
+
+    ini.BeginBatch();
+    try
+    {
+        for(size_t i = 0; i < names.size(); ++i)
+        {
+            ini.AddValue(section_name, names[i], stringified_values[i]);
+        }
+    }
+    catch(...)
+    {
+        ini.EndBatch();
+        throw;
+    }
+    ini.EndBatch();
+}
+
+/// Converts the whole buffer into nested dicts [section_name | [key_name | native value]].
+py::dict BufferToDict(const IniBuffer& ini)
+{
+    py::dict sections;
+    ini.ForEachSection([&](const std::string& section_name)
+    {
+        sections[py::str(section_name)] = SectionToDict(ini, section_name);
+    });
+    return sections;
+}
+
 #endif
@@ -10,6 +10,14 @@
 
 namespace py = pybind11;
 
+/// Selects the std::string overload of the IniBuffer::GetValue<ValueT> overload set.
+template<typename ValueT>
+using GetValue_t = ValueT (IniBuffer::*)(const std::string&, const std::string&) const;
+
+/// Selects the std::string overload of the IniBuffer::AddValue<ValueT> overload set.
+template<typename ValueT>
+using AddValue_t = void (IniBuffer::*)(const std::string&, const std::string&, const ValueT&);
+
 PYBIND11_MODULE(IniBuffer, m)
 {
 //-----------------------------------------------------------------------------------------------------------------------------------------
@@ -33,28 +41,82 @@ PYBIND11_MODULE(IniBuffer, m)
 //-----------------------------------------------------------------------------------------------------------------------------------------
 // Load File
 
-        .def("LoadFile", &IniBuffer::LoadFile,
+        .def("LoadFile", &LoadFile,
         R"pbdoc(
         Loads a specified ini-file and parses it into the buffer.
 
+        Details:
+        The GIL is released while parsing, so other Python threads keep running.
+        The file is parsed into a separate buffer, whose content is moved into this buffer after taking the GIL back.
+        Thus other threads may keep using this buffer while it is loading.
+
         Args:
         fullfilename: The path and filename pointing to the configuration file.)pbdoc",
         py::arg("fullfilename")
         )
 
-        .def("WriteFile", &IniBuffer::WriteFile,
+        .def("LoadBytes", &LoadBytes,
+        R"pbdoc(
+        Parses ini content from memory into the buffer without a temporary file.
+
+        Details:
+        Accepts any contiguous buffer of bytes, e.g. bytes, bytearray, memoryview or mmap. The content is not copied.
+        The GIL is released while parsing into a separate buffer, like LoadFile does. A bytearray can not be resized while it is parsed.
+
+        Args:
+        content: The ini content.
+        base_directory: Directory which relative include paths are interpreted relative to. Empty for the current working directory.)pbdoc",
+        py::arg("content"),
+        py::arg("base_directory") = ""
+        )
+
+        .def("LoadString", &LoadString,
+        R"pbdoc(
+        Parses ini content from a str into the buffer without a temporary file.
+
+        Details:
+        The content is parsed in its UTF-8 representation. The GIL is released while parsing, like LoadFile does.
+
+        Args:
+        content: The ini content.
+        base_directory: Directory which relative include paths are interpreted relative to. Empty for the current working directory.)pbdoc",
+        py::arg("content"),
+        py::arg("base_directory") = ""
+        )
+
+        .def("WriteFile", &WriteFile,
         R"pbdoc(
         Writes the internal buffer state into the specified file.
 
         Details:
         The specified path (not the file) must exist.
         If an error occurres during parsing or opening the file, an IniException is thrown.
+        The buffer is copied with the GIL held. The GIL is released while the copy is written,
+        so other Python threads keep running and may modify the buffer meanwhile.
 
         Args:
-        fullfilename: The path and filename pointing to the configuration file.)pbdoc",
-        py::arg("fullfilename")
+        fullfilename: The path and filename pointing to the configuration file.
+        with_header: Writes a comment header with the current date and time. Without it, the output is deterministic.
+        thread_count: Maximal number of threads formatting content larger than 4 MB. 0 uses one thread per core.)pbdoc",
+        py::arg("fullfilename"),
+        py::arg("with_header") = true,
+        py::arg("thread_count") = 0
         )
 
+        .def("Save", &IniBuffer::Save,
+        R"pbdoc(
+        Writes the changes since loading or saving back into the loaded file.
+
+        Details:
+        Only changed sections are formatted, all other bytes including comments are copied from the file.
+        Changes are tracked if the buffer was empty when LoadFile loaded a file without include directives.
+        If the changes are not tracked or the file was modified by someone else, an IniException is thrown.
+        The GIL is held while saving, since Save updates the change tracking of the buffer.)pbdoc"
+        )
+
+        .def("IsDirty", &IniBuffer::IsDirty,
+        R"pbdoc(Returns whether the buffer has changes which Save would write.)pbdoc")
+
 //-----------------------------------------------------------------------------------------------------------------------------------------
 // Clear
 
@@ -64,7 +126,7 @@ PYBIND11_MODULE(IniBuffer, m)
 //-----------------------------------------------------------------------------------------------------------------------------------------
 // Erase Section
 
-        .def("EraseSection", &IniBuffer::EraseSection,
+        .def("EraseSection", static_cast<void (IniBuffer::*)(const std::string&)>(&IniBuffer::EraseSection),
         R"pbdoc(Deletes a whole section in the buffer.
 
         Args:
@@ -77,7 +139,7 @@ PYBIND11_MODULE(IniBuffer, m)
 //-----------------------------------------------------------------------------------------------------------------------------------------
 // Erase Property
 
-        .def("EraseProperty", &IniBuffer::EraseProperty,
+        .def("EraseProperty", static_cast<void (IniBuffer::*)(const std::string&, const std::string&)>(&IniBuffer::EraseProperty),
         R"pbdoc(Deletes a key/value pair in the buffer.
 
         Args:
@@ -91,7 +153,7 @@ PYBIND11_MODULE(IniBuffer, m)
 //-----------------------------------------------------------------------------------------------------------------------------------------
 // GetValue<int>
 
-        .def("GetValue_int", &IniBuffer::GetValue<int>,
+        .def("GetValue_int", static_cast<GetValue_t<int>>(&IniBuffer::GetValue<int>),
         R"pbdoc(Receive a requested value from the buffer.
 
         Details:
@@ -112,7 +174,7 @@ PYBIND11_MODULE(IniBuffer, m)
 //-----------------------------------------------------------------------------------------------------------------------------------------
 // GetValue<double>
 
-        .def("GetValue_float", &IniBuffer::GetValue<py::float_>,
+        .def("GetValue_float", static_cast<GetValue_t<py::float_>>(&IniBuffer::GetValue<py::float_>),
         R"pbdoc(Receive a requested value from the buffer.
 
         Details:
@@ -133,7 +195,7 @@ PYBIND11_MODULE(IniBuffer, m)
 //-----------------------------------------------------------------------------------------------------------------------------------------
 // GetValue<bool>
 
-        .def("GetValue_bool", &IniBuffer::GetValue<bool>,
+        .def("GetValue_bool", static_cast<GetValue_t<bool>>(&IniBuffer::GetValue<bool>),
         R"pbdoc(Receive a requested value from the buffer.
 
         Details:
@@ -154,7 +216,7 @@ PYBIND11_MODULE(IniBuffer, m)
 //-----------------------------------------------------------------------------------------------------------------------------------------
 // GetValue<std::string>
 
-        .def("GetValue_string", &IniBuffer::GetValue<std::string>,
+        .def("GetValue_string", static_cast<GetValue_t<std::string>>(&IniBuffer::GetValue<std::string>),
         R"pbdoc(Receive a requested value from the buffer.
 
         Details:
@@ -175,7 +237,7 @@ PYBIND11_MODULE(IniBuffer, m)
 //-----------------------------------------------------------------------------------------------------------------------------------------
 // AddValue<int>
 
-        .def("AddValue", &IniBuffer::AddValue<int>,
+        .def("AddValue", static_cast<AddValue_t<int>>(&IniBuffer::AddValue<int>),
         R"pbdoc(Inserts a certain value into the ini file buffer.
         Details:
         If an error occurred during the operation an IniException is thrown.
@@ -194,7 +256,7 @@ PYBIND11_MODULE(IniBuffer, m)
 //-----------------------------------------------------------------------------------------------------------------------------------------
 // AddValue<float>
 
-        .def("AddValue", &IniBuffer::AddValue<float>,
+        .def("AddValue", static_cast<AddValue_t<py::float_>>(&IniBuffer::AddValue<py::float_>),
         R"pbdoc(Inserts a certain value into the ini file buffer.
         Details:
         If an error occurred during the operation an IniException is thrown.
@@ -213,7 +275,7 @@ PYBIND11_MODULE(IniBuffer, m)
 //-----------------------------------------------------------------------------------------------------------------------------------------
 // AddValue<bool>
 
-        .def("AddValue", &IniBuffer::AddValue<bool>,
+        .def("AddValue", static_cast<AddValue_t<bool>>(&IniBuffer::AddValue<bool>),
         R"pbdoc(Inserts a certain value into the ini file buffer.
         Details:
         If an error occurred during the operation an IniException is thrown.
@@ -232,7 +294,7 @@ PYBIND11_MODULE(IniBuffer, m)
 //-----------------------------------------------------------------------------------------------------------------------------------------
 // AddValue<std::string>
 
-        .def("AddValue", &IniBuffer::AddValue<std::string>,
+        .def("AddValue", static_cast<AddValue_t<std::string>>(&IniBuffer::AddValue<std::string>),
         R"pbdoc(Inserts a certain value into the ini file buffer.
         Details:
         If an error occurred during the operation an IniException is thrown.
@@ -246,7 +308,253 @@ PYBIND11_MODULE(IniBuffer, m)
         py::arg("section_name"),
         py::arg("key_neame"),
         py::arg("value")
-        );
+        )
+
+//-----------------------------------------------------------------------------------------------------------------------------------------
+// Native get and set
+
+        .def("get", &GetNative,
+        R"pbdoc(Receive a requested value from the buffer as int, float, bool or str, depending on its detected type.
+
+        Details:
+        Empty values are returned as None. Values which can not be converted to their detected type are returned as str.
+        If the value is not present, an IniException is thrown.
+
+        Args:
+        section_name: Specifier of the section to which the value belongs to.
+        key_name: Corresponding value key.
+
+        Return:
+        The requested value.
+        )pbdoc",
+        py::arg("section_name"),
+        py::arg("key_name")
+        )
+
+        .def("set", &SetNative,
+        R"pbdoc(Inserts a value of type int, float, bool or str into the buffer.
+
+        Details:
+        The type is dispatched once. Ints are stored with all their digits.
+        Other types raise a TypeError.
+
+        Args:
+        section_name: Name of the section where the value is stored in the ini-file.
+        key_name: Name of the property key where the value is stored in the ini-file.
+        value: The value being inserted by the method.
+        )pbdoc",
+        py::arg("section_name"),
+        py::arg("key_name"),
+        py::arg("value")
+        )
+
+//-----------------------------------------------------------------------------------------------------------------------------------------
+// Batched lookups
+
+        .def("get_many", &GetManyOfSection,
+        R"pbdoc(Receive several values of one section in one call.
+
+        Details:
+        Values are converted the same way as by get. Missing keys do not raise, they are returned as default.
+
+        Args:
+        section_name: Specifier of the section to which the values belong to.
+        key_names: Iterable of the requested keys.
+        default: Returned for keys which are not present.
+
+        Return:
+        A list with one value per requested key.
+        )pbdoc",
+        py::arg("section_name"),
+        py::arg("key_names"),
+        py::arg("default") = py::none()
+        )
+
+        .def("get_many", &GetMany,
+        R"pbdoc(Receive several values of any sections in one call.
+
+        Details:
+        Values are converted the same way as by get. Missing keys do not raise, they are returned as default.
+
+        Args:
+        names: Iterable of (section_name, key_name) tuples.
+        default: Returned for keys which are not present.
+
+        Return:
+        A list with one value per requested key.
+        )pbdoc",
+        py::arg("names"),
+        py::arg("default") = py::none()
+        )
+
+//-----------------------------------------------------------------------------------------------------------------------------------------
+// Bulk export
+
+        .def("to_dict", &BufferToDict,
+        R"pbdoc(Exports the whole buffer into nested dicts in one call.
+
+        Details:
+        Values are converted to int, float, bool or str by their detected type. Empty values become None.
+        Values which can not be converted to their detected type are returned as str.
+
+        Return:
+        A dict {section_name: {key_name: value}}.
+        )pbdoc")
+
+        .def("section_dict", &SectionToDict,
+        R"pbdoc(Exports one section into a dict in one call.
+
+        Details:
+        Values are converted the same way as by to_dict.
+        If the section is not present, an IniException is thrown.
+
+        Args:
+        section_name: Name of the exported section.
+
+        Return:
+        A dict {key_name: value}.
+        )pbdoc",
+        py::arg("section_name")
+        )
+
+        .def("get_array", &GetArray,
+        R"pbdoc(Exports the int and float values of a section into a new numpy array.
+
+        Details:
+        Only values detected as int or float whose key matches the pattern are exported, in the order of get_array_keys.
+        The values are written directly into the array, no python object is created per value.
+        Requires numpy. If the section is not present, an IniException is thrown.
+
+        Args:
+        section_name: Name of the exported section.
+        pattern: Key pattern with the wildcards * and ?.
+        dtype: "float64" or "int64". Float values can not be exported as int64.
+
+        Return:
+        A one dimensional numpy array.
+        )pbdoc",
+        py::arg("section_name"), py::arg("pattern") = "*", py::arg("dtype") = "float64")
+
+        .def("export_array", &ExportArray,
+        R"pbdoc(Exports the int and float values of a section into an existing buffer.
+
+        Details:
+        Works like get_array without numpy. The output can be any writable one dimensional buffer of 64 bit floats or ints,
+        e.g. a numpy array, an array.array("d") or an array.array("q"). It must have one element per exported value,
+        otherwise a ValueError is raised. If the call fails, the output is left untouched.
+
+        Args:
+        section_name: Name of the exported section.
+        out: Writable buffer which receives the values.
+        pattern: Key pattern with the wildcards * and ?.
+
+        Return:
+        The number of written values.
+        )pbdoc",
+        py::arg("section_name"), py::arg("out"), py::arg("pattern") = "*")
+
+        .def("get_array_keys", &GetArrayKeys,
+        R"pbdoc(Returns the keys of the values exported by get_array and export_array, in the same order.
+
+        Args:
+        section_name: Name of the section.
+        pattern: Key pattern with the wildcards * and ?.
+
+        Return:
+        A list of key names.
+        )pbdoc",
+        py::arg("section_name"), py::arg("pattern") = "*")
+
+        .def("set_array", &ImportArray,
+        R"pbdoc(Stores the elements of a numeric array under the given keys of a section.
+
+        Details:
+        The values can be any one dimensional buffer of numbers or bools, e.g. a numpy array or an array.array.
+        Floats are stored with all digits needed to read back the same value, non finite floats are rejected.
+        Nothing is stored if an element can not be converted. Subscribers are notified once for all changes.
+
+        Args:
+        section_name: Name of the section.
+        key_names: One key name per element.
+        values: Buffer with the values.
+        )pbdoc",
+        py::arg("section_name"), py::arg("key_names"), py::arg("values")
+        )
+
+//-----------------------------------------------------------------------------------------------------------------------------------------
+// Mapping Protocol
+
+        .def("__getitem__", &GetSectionProxy,
+        R"pbdoc(Returns a lazy view of a section, e.g. ini["Circle"]["Diameter"]. Raises a KeyError if the section is not present.)pbdoc",
+        py::arg("section_name"), py::keep_alive<0, 1>())
+
+        .def("__delitem__", &DeleteSection,
+        R"pbdoc(Erases a section. Raises a KeyError if the section is not present.)pbdoc",
+        py::arg("section_name"))
+
+        .def("__contains__", &IniBuffer::HasSection,
+        R"pbdoc(Checks if a section is present.)pbdoc",
+        py::arg("section_name"))
+
+        .def("__iter__", [](const IniBuffer& ini){return py::iter(GetSectionNames(ini));},
+        R"pbdoc(Iterates over the section names.)pbdoc")
+
+        .def("__len__", &IniBuffer::GetSectionCount,
+        R"pbdoc(Returns the number of sections.)pbdoc")
+
+        .def("keys", &GetSectionNames,
+        R"pbdoc(Returns a list of the section names.)pbdoc")
+        ;
+
+//-----------------------------------------------------------------------------------------------------------------------------------------
+// Class Section
+
+    py::class_<SectionProxy>(m, "Section",
+        R"pbdoc(
+        Lazy view of one section of an IniBuffer, returned by ini[section_name].
+
+        Details:
+        Values are looked up and converted to int, float, bool or str on access, nothing is copied in advance.
+        Missing keys raise a KeyError. The view keeps its IniBuffer alive.
+        )pbdoc")
+
+        .def_property_readonly("name", [](const SectionProxy& proxy){return proxy.section_name;},
+        R"pbdoc(Name of the viewed section.)pbdoc")
+
+        .def("__getitem__", &GetProxyValue,
+        R"pbdoc(Returns a value converted by its detected type. Raises a KeyError if the key is not present.)pbdoc",
+        py::arg("key_name"))
+
+        .def("__setitem__", [](const SectionProxy& proxy, const std::string& key_name, const py::handle& value){SetNative(*proxy.ini, proxy.section_name, key_name, value);},
+        R"pbdoc(Stores an int, float, bool or str value like IniBuffer.set.)pbdoc",
+        py::arg("key_name"), py::arg("value"))
+
+        .def("__delitem__", &DeleteProxyValue,
+        R"pbdoc(Erases a property. Raises a KeyError if the key is not present.)pbdoc",
+        py::arg("key_name"))
+
+        .def("__contains__", &ProxyContains,
+        R"pbdoc(Checks if a key is present.)pbdoc",
+        py::arg("key_name"))
+
+        .def("__iter__", [](const SectionProxy& proxy){return py::iter(GetProxyKeys(proxy));},
+        R"pbdoc(Iterates over the key names.)pbdoc")
+
+        .def("__len__", &GetProxyLength,
+        R"pbdoc(Returns the number of properties.)pbdoc")
+
+        .def("__repr__", [](const SectionProxy& proxy){return "<Section '" + proxy.section_name + "'>";})
+
+        .def("get", [](const SectionProxy& proxy, const std::string& key_name, const py::object& default_value){return GetNativeOrDefault(*proxy.ini, proxy.section_name, key_name, default_value);},
+        R"pbdoc(Returns a value converted by its detected type, or default if the key is not present.)pbdoc",
+        py::arg("key_name"), py::arg("default") = py::none())
+
+        .def("keys", &GetProxyKeys,
+        R"pbdoc(Returns a list of the key names.)pbdoc")
+
+        .def("items", &GetProxyItems,
+        R"pbdoc(Returns a list of (key_name, value) tuples.)pbdoc")
+        ;
 
     m.attr("__version__") = "dev";
 }
@@ -0,0 +1,909 @@
+/**
+ * @file ini_buffer_test.cpp
+ * @author Pascal Enderli
+ * @date 2026.10.18
+ * @brief Tests of loading, modifying and writing an IniBuffer.
+ */
+
+#include<algorithm>
+#include<chrono>
+#include<cstdio>
+#include<thread>
+#include"ini_buffer.h"
+#include"test_util.h"
+
+//-----------------------------------------------------------------------------------
+// Reader
+
+/// Records the events of an IniReader as "<line_nr> <event> <content> <offset>-<end offset>".
+class EventRecorder: public IniHandler
+{
+    public:
+
+    void OnSection(const StringView& section_name, size_t line_nr) override
+    {
+        Record(line_nr, "section " + section_name.ToString());
+    }
+
+    void OnProperty(const StringView& key_name, const StringView& value, size_t line_nr) override
+    {
+        Record(line_nr, "property " + key_name.ToString() + "=" + value.ToString());
+    }
+
+    void OnComment(const StringView& comment, size_t line_nr) override
+    {
+        Record(line_nr, "comment " + comment.ToString());
+    }
+
+    void OnInclude(const StringView& path, size_t line_nr) override
+    {
+        Record(line_nr, "include " + path.ToString());
+    }
+
+    void Record(size_t line_nr, const std::string& event)
+    {
+        events.push_back(std::to_string(line_nr) + " " + event + " " +
+                         std::to_string(reader->GetLineOffset()) + "-" + std::to_string(reader->GetLineEndOffset()));
+    }
+
+    const IniReader* reader = nullptr;
+    std::vector<std::string> events;
+};
+
+const std::string reader_input = "; head\n[A] ; header\na = 1 ; inline\n\n!include common.ini\n# hash\nb = two words";
+
+const std::vector<std::string> reader_events =
+{
+    "1 comment head 0-7",
+    "2 section A 7-20",
+    "2 comment header 7-20",
+    "3 property a=1 20-35",
+    "3 comment inline 20-35",
+    "5 include common.ini 36-56",
+    "6 comment hash 56-63",
+    "7 property b=two words 63-76"
+};
+
+void TestReaderEvents()
+{
+    EventRecorder recorder;
+    IniReader reader(recorder);
+    recorder.reader = &reader;
+    reader.Read(reader_input.data(), reader_input.size());
+    CHECK(recorder.events.size() == 7);
+    reader.Finish();
+    CHECK(recorder.events == reader_events);
+    CHECK(!reader.EndsWithLineBreak());
+
+    // Finish resets the line numbers and offsets for the next input.
+    recorder.events.clear();
+    const std::string input = reader_input + "\n";
+    reader.Read(input.data(), input.size());
+    reader.Finish();
+    CHECK(recorder.events.size() == reader_events.size());
+    CHECK(recorder.events.front() == reader_events.front());
+    CHECK(recorder.events.back() == "7 property b=two words 63-77");
+    CHECK(reader.EndsWithLineBreak());
+}
+
+void TestReaderChunks()
+{
+    // Lines which span chunks are reported the same way as lines inside a chunk.
+    for(size_t chunk_size : {1, 2, 5, 16})
+    {
+        EventRecorder recorder;
+        IniReader reader(recorder);
+        recorder.reader = &reader;
+        for(size_t offset = 0; offset < reader_input.size(); offset += chunk_size)
+        {
+            reader.Read(reader_input.data() + offset, std::min(chunk_size, reader_input.size() - offset));
+        }
+        reader.Finish();
+        CHECK(recorder.events == reader_events);
+    }
+
+    EventRecorder recorder;
+    IniReader reader(recorder);
+    recorder.reader = &reader;
+    std::istringstream stream(reader_input);
+    reader.ReadStream(stream);
+    CHECK(recorder.events == reader_events);
+}
+
+void TestReaderErrors()
+{
+    IniHandler ignoring_handler;
+    IniReader reader(ignoring_handler);
+    const std::string invalid[] = {"a = 1\n", "[A]\n!import other.ini\n", "[A\n", "[A]\na b = 1\n", "[A]\nvalue\n"};
+    for(const std::string& input : invalid)
+    {
+        CHECK_THROWS(reader.Read(input.data(), input.size()), IniException);
+        reader.Finish();
+    }
+
+    // The default handler ignores all events.
+    const std::string valid = "[A]\na = 1 ; comment\n!include missing.ini\n";
+    reader.Read(valid.data(), valid.size());
+    reader.Finish();
+}
+
+//-----------------------------------------------------------------------------------
+// Includes
+
+void TestRepeatedSectionsAreMerged()
+{
+    IniBuffer ini;
+    ini.LoadFromString("[A]\na = 1\nb = 2\n[B]\nc = 3\n[A]\nb = 20\nd = 4\n");
+    CHECK(ini.GetValue<int>("A", "a") == 1);
+    CHECK(ini.GetValue<int>("A", "b") == 20);
+    CHECK(ini.GetValue<int>("A", "d") == 4);
+    CHECK(ini.GetValue<int>("B", "c") == 3);
+}
+
+void TestIncludedSectionsAreMerged()
+{
+    WriteTextFile("results/common.ini", "[A]\nb = 20\nc = 30\n[C]\ne = 5\n");
+
+    IniBuffer ini;
+    ini.LoadFromString("[A]\na = 1\nb = 2\n!include common.ini\nf = 6\n", "results");
+    CHECK(ini.GetValue<int>("A", "a") == 1);
+    CHECK(ini.GetValue<int>("A", "b") == 20);
+    CHECK(ini.GetValue<int>("A", "c") == 30);
+    CHECK(ini.GetValue<int>("C", "e") == 5);
+
+    // Properties following the include belong to the section active before it.
+    CHECK(ini.GetValue<int>("A", "f") == 6);
+    CHECK_THROWS(ini.GetValue<int>("C", "f"), IniException);
+
+    // A repeated header and an include produce the same section.
+    IniBuffer repeated;
+    repeated.LoadFromString("[A]\na = 1\nb = 2\n[A]\nb = 20\nc = 30\n[C]\ne = 5\n[A]\nf = 6\n");
+    CHECK(repeated.WriteToString() == ini.WriteToString());
+}
+
+void TestLoadReplacesExistingSections()
+{
+    WriteTextFile("results/common.ini", "[A]\nb = 20\n");
+
+    IniBuffer ini;
+    ini.LoadFromString("[A]\nold = 1\n[B]\nold = 2\n[C]\nold = 3\n");
+    ini.LoadFromString("[A]\na = 1\n[A]\nx = 2\n!include common.ini\n[B]\n", "results/");
+    CHECK_THROWS(ini.GetStringRef("A", "old"), IniException);
+    CHECK(ini.GetValue<int>("A", "x") == 2);
+    CHECK(ini.GetValue<int>("A", "b") == 20);
+    CHECK_THROWS(ini.GetStringRef("B", "old"), IniException);
+    CHECK(ini.GetValue<int>("C", "old") == 3);
+
+    // A section defined only by an included file replaces the loaded one as well.
+    ini.LoadFromString("!include common.ini\n", "results");
+    CHECK_THROWS(ini.GetStringRef("A", "a"), IniException);
+    CHECK(ini.GetValue<int>("A", "b") == 20);
+}
+
+void TestIncludeBaseDirectory()
+{
+    WriteTextFile("results/base.ini", "[Base]\nvalue = 1\n");
+
+    IniBuffer ini;
+    CHECK_THROWS(ini.LoadFromString("!include base.ini\n"), IniException);
+
+    std::istringstream stream("!include base.ini\n");
+    ini.LoadFromStream(stream, "results");
+    CHECK(ini.GetValue<int>("Base", "value") == 1);
+
+    BasicIniBuffer<SortedVectorStorage> sorted;
+    sorted.LoadFromString("[Base]\nlocal = 2\n!include base.ini\n", "results/");
+    CHECK(sorted.GetValue<int>("Base", "value") == 1);
+    CHECK(sorted.GetValue<int>("Base", "local") == 2);
+}
+
+void TestAdoptLoadedBuffer()
+{
+    WriteTextFile("results/adopted.ini", "[A]\na = 1\n[B]\nb = 2\n");
+
+    // An empty buffer takes over the change tracking.
+    IniBuffer loaded;
+    loaded.LoadFile("results/adopted.ini");
+    IniBuffer ini;
+    ini.Adopt(std::move(loaded));
+    CHECK(loaded.WriteToString().empty());
+    CHECK(ini.GetValue<int>("B", "b") == 2);
+    CHECK(!ini.IsDirty());
+    ini.AddValue("A", "a", 10);
+    ini.Save();
+    CHECK(ReadTextFile("results/adopted.ini") == "[A]\na = 10\n\n[B]\nb = 2\n");
+
+    // Otherwise sections are replaced like a load does.
+    int notifications = 0;
+    ini.Subscribe("A", "*", [&](const std::vector<IniBufferBase::Change>&){++notifications;});
+    BasicIniBuffer<SortedVectorStorage> expected;
+    expected.LoadFromString("[A]\na = 10\n[B]\nb = 2\n");
+    expected.LoadFromString("[A]\nc = 3\n[C]\nd = 4\n");
+    loaded.LoadFromString("[A]\nc = 3\n[C]\nd = 4\n");
+    ini.Adopt(std::move(loaded));
+    CHECK(ini.WriteToString() == expected.WriteToString());
+    CHECK(notifications == 1);
+    CHECK(ini.IsDirty());
+}
+
+void TestCacheReusesUnchangedFiles()
+{
+    IniCache::Clear();
+    const std::string fullfilename = "results/cached.ini";
+    WriteTextFile(fullfilename, "[A]\na = 1\n");
+    std::shared_ptr<const IniBuffer> first = IniCache::Get(fullfilename);
+    CHECK(IniCache::Get(fullfilename) == first);
+    CHECK(IniCache::GetMemoryUsage() > 0);
+
+    // Changed size.
+    WriteTextFile(fullfilename, "[A]\na = 10\n");
+    std::shared_ptr<const IniBuffer> second = IniCache::Get(fullfilename);
+    CHECK(second != first);
+    CHECK(second->GetValue<int>("A", "a") == 10);
+
+    // Same size, changed modification time.
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    WriteTextFile(fullfilename, "[A]\na = 20\n");
+    std::shared_ptr<const IniBuffer> third = IniCache::Get(fullfilename);
+    CHECK(third != second);
+    CHECK(third->GetValue<int>("A", "a") == 20);
+
+    // Same size, replaced by another file.
+    WriteTextFile("results/cached_replacement.ini", "[A]\na = 30\n");
+    CHECK(std::rename("results/cached_replacement.ini", fullfilename.c_str()) == 0);
+    std::shared_ptr<const IniBuffer> fourth = IniCache::Get(fullfilename);
+    CHECK(fourth != third);
+    CHECK(fourth->GetValue<int>("A", "a") == 30);
+    CHECK(IniCache::Get(fullfilename) == fourth);
+    IniCache::Clear();
+    CHECK(IniCache::GetMemoryUsage() == 0);
+}
+
+void TestCacheEvictsLeastRecentlyUsed()
+{
+    IniCache::Clear();
+    WriteTextFile("results/cached_a.ini", "[A]\na = 1\n");
+    WriteTextFile("results/cached_b.ini", "[B]\nb = 2\n");
+    WriteTextFile("results/cached_c.ini", "[C]\nc = 3\n");
+    std::shared_ptr<const IniBuffer> a = IniCache::Get("results/cached_a.ini");
+    std::shared_ptr<const IniBuffer> b = IniCache::Get("results/cached_b.ini");
+    std::shared_ptr<const IniBuffer> c = IniCache::Get("results/cached_c.ini");
+    CHECK(IniCache::Get("results/cached_a.ini") == a);
+
+    // b is the least recently used file.
+    const size_t memory_usage = IniCache::GetMemoryUsage();
+    IniCache::SetMemoryBudget(memory_usage - 1);
+    CHECK(IniCache::GetMemoryUsage() < memory_usage);
+    CHECK(IniCache::Get("results/cached_c.ini") == c);
+    CHECK(IniCache::Get("results/cached_a.ini") == a);
+    std::shared_ptr<const IniBuffer> reparsed_b = IniCache::Get("results/cached_b.ini");
+    CHECK(reparsed_b != b);
+
+    // Adding b evicted c, which was used before a.
+    CHECK(IniCache::Get("results/cached_a.ini") == a);
+    CHECK(IniCache::Get("results/cached_c.ini") != c);
+
+    // The most recently used file stays cached even if it exceeds the budget alone.
+    IniCache::SetMemoryBudget(0);
+    CHECK(IniCache::GetMemoryUsage() > 0);
+    IniCache::SetMemoryBudget(256*1024*1024);
+    IniCache::Clear();
+}
+
+void TestCacheFollowsIncludedFiles()
+{
+    IniCache::Clear();
+    WriteTextFile("results/cached_child.ini", "[Child]\nvalue = 1\n");
+    WriteTextFile("results/cached_parent.ini", "[Parent]\nvalue = 0\n!include cached_child.ini\n");
+    std::shared_ptr<const IniBuffer> parent = IniCache::Get("results/cached_parent.ini");
+    CHECK(parent->GetValue<int>("Child", "value") == 1);
+    CHECK(IniCache::Get("results/cached_parent.ini") == parent);
+
+    WriteTextFile("results/cached_child.ini", "[Child]\nvalue = 22\n");
+    std::shared_ptr<const IniBuffer> reparsed = IniCache::Get("results/cached_parent.ini");
+    CHECK(reparsed != parent);
+    CHECK(reparsed->GetValue<int>("Child", "value") == 22);
+    CHECK(IniCache::Get("results/cached_parent.ini") == reparsed);
+    IniCache::Clear();
+}
+
+//-----------------------------------------------------------------------------------
+// Serialization
+
+void TestWriteToMemoryRoundTrip()
+{
+    IniBuffer ini;
+    ini.LoadFromString("[Circle]\nDiameter = 700\nColor = red\nhas_edges = false\nRatio = 0.5\n[Empty]\n[Square]\nmaterial = oak wood\n");
+    ini.WriteFile("results/round_trip.ini", false);
+    const std::string expected = ReadTextFile("results/round_trip.ini");
+    const std::string header_begin = "# Configuration File\n# ";
+
+    for(bool with_header : {false, true})
+    {
+        std::string buffer;
+        ini.WriteToBuffer(buffer, with_header);
+        std::ostringstream stream;
+        ini.WriteToStream(stream, with_header);
+        const std::string outputs[] = {ini.WriteToString(with_header), buffer, stream.str()};
+        for(const std::string& output : outputs)
+        {
+            CHECK(with_header ? output.compare(0, header_begin.size(), header_begin) == 0 : output == expected);
+            CHECK(output.size() >= expected.size() && output.compare(output.size() - expected.size(), expected.size(), expected) == 0);
+
+            IniBuffer loaded;
+            loaded.LoadFromString(output);
+            CHECK(loaded.WriteToString() == expected);
+            CHECK(loaded.GetValue<float>("Circle", "Ratio") == 0.5f);
+            CHECK(loaded.GetStringRef("Square", "material") == "oak wood");
+        }
+    }
+}
+
+void TestWriteToBufferReuse()
+{
+    IniBuffer ini;
+    ini.LoadFromString("[A]\na = 1\n");
+    std::string buffer = "previous content which is longer than the serialized buffer";
+    buffer.reserve(4096);
+    const char* data = buffer.data();
+
+    // The content is replaced without reallocating the buffer.
+    ini.WriteToBuffer(buffer);
+    CHECK(buffer == "[A]\na = 1\n\n");
+    ini.AddValue("B", "b", std::string("two"));
+    ini.WriteToBuffer(buffer);
+    CHECK(buffer == "[A]\na = 1\n\n[B]\nb = two\n\n");
+    CHECK(buffer.data() == data);
+
+    IniBuffer().WriteToBuffer(buffer);
+    CHECK(buffer.empty());
+}
+
+void TestWriteToFailedStream()
+{
+    IniBuffer ini;
+    ini.LoadFromString("[A]\na = 1\n");
+    std::ostringstream stream;
+    stream.setstate(std::ios::badbit);
+    CHECK_THROWS(ini.WriteToStream(stream), IniException);
+
+    stream.clear();
+    stream.exceptions(std::ios::badbit);
+    stream.setstate(std::ios::failbit);
+    CHECK_THROWS(ini.WriteToStream(stream), IniException);
+}
+
+void TestCStringOverloads()
+{
+    IniBuffer ini;
+    ini.AddValue("Circle", "Diameter", 700);
+    ini.AddValue("Circle", "Color", std::string("red"));
+    CHECK(ini.GetValue<int>("Circle", "Diameter") == 700);
+    CHECK(ini.GetStringRef("Circle", "Color") == "red");
+    CHECK(ini.GetStringRef("Circle_", 6, "Color_", 5) == "red");
+
+    IniBufferBase::BoundValue<int> diameter = ini.Bind<int>("Circle", "Diameter");
+    ini.AddValue("Circle", "Diameter", 800);
+    CHECK(diameter.Get() == 800);
+
+    const char* missing = nullptr;
+    CHECK_THROWS(ini.AddValue(missing, "Diameter", 1), IniException);
+    CHECK_THROWS(ini.GetStringRef("Circle", missing), IniException);
+    CHECK_THROWS(ini.Bind<int>(missing, "Diameter"), IniException);
+}
+
+void TestNestedCStringLookups()
+{
+    IniBuffer ini;
+    ini.LoadFromString("[A]\na = 1\nb = 2\n[Other]\nkey = 3\n");
+
+    // A callback looking up other names with C strings does not overwrite the names of the running call.
+    int looked_up = 0;
+    ini.Subscribe("A", "*", [&](const std::vector<IniBufferBase::Change>&)
+    {
+        looked_up += ini.GetValue<int>("Other", "key");
+    });
+    ini.EraseProperty("A", "a");
+    ini.AddValue("A", "c", 4);
+    ini.EraseSection("A");
+    CHECK(looked_up == 9);
+    CHECK_THROWS(ini.GetStringRef("A", "b"), IniException);
+    CHECK_THROWS(ini.GetStringRef("A", "c"), IniException);
+    CHECK(ini.GetValue<int>("Other", "key") == 3);
+}
+
+/// Returns a callback which appends each notification as sorted "section/key" names separated by spaces.
+IniBufferBase::Callback_t RecordChanges(std::vector<std::string>& notifications)
+{
+    return [&notifications](const std::vector<IniBufferBase::Change>& changes)
+    {
+        std::vector<std::string> names;
+        for(const IniBufferBase::Change& change : changes)
+        {
+            names.push_back(change.section_name + "/" + change.key_name);
+        }
+        std::sort(names.begin(), names.end());
+
+        std::string notification;
+        for(const std::string& name : names)
+        {
+            notification += (notification.empty() ? "" : " ") + name;
+        }
+        notifications.push_back(notification);
+    };
+}
+
+void TestBatchCoalescesChanges()
+{
+    IniBuffer ini;
+    std::vector<std::string> section_a;
+    std::vector<std::string> key_b;
+    ini.Subscribe("A", "*", RecordChanges(section_a));
+    ini.Subscribe("B", "b", RecordChanges(key_b));
+
+    ini.BeginBatch();
+    ini.AddValue("A", "a", 1);
+    ini.AddValue("A", "a", 2);
+    ini.BeginBatch();
+    ini.AddValue("A", "b", 3);
+    ini.AddValue("B", "b", 4);
+    ini.EndBatch();
+    ini.AddValue("B", "c", 5);
+    CHECK(section_a.empty() && key_b.empty());
+    ini.EndBatch();
+    CHECK(section_a == std::vector<std::string>{"A/a A/b"});
+    CHECK(key_b == std::vector<std::string>{"B/b"});
+    CHECK_THROWS(ini.EndBatch(), IniException);
+
+    // Unchanged values and other keys are not reported.
+    ini.AddValue("A", "a", 2);
+    ini.AddValue("B", "c", 6);
+    CHECK(section_a.size() == 1 && key_b.size() == 1);
+    ini.EraseProperty("B", "b");
+    CHECK(key_b.size() == 2 && key_b.back() == "B/b");
+}
+
+void TestLoadNotifiesSubscribers()
+{
+    IniBuffer ini;
+    ini.LoadFromString("[A]\na = 1\nb = 2\n");
+    std::vector<std::string> section_a;
+    ini.Subscribe("A", "*", RecordChanges(section_a));
+
+    // A load is one batch which reports the properties differing from the content before.
+    ini.LoadFromString("[A]\na = 1\nb = 20\nc = 3\n");
+    CHECK(section_a == std::vector<std::string>{"A/b A/c"});
+    ini.LoadFromString("[A]\na = 1\nb = 20\nc = 3\n");
+    CHECK(section_a.size() == 1);
+
+    // Content loaded before an error is reported, and the batch of the load is ended.
+    CHECK_THROWS(ini.LoadFromString("[A]\nb = 30\n[Broken\n"), IniException);
+    CHECK(section_a.size() == 2 && section_a.back() == "A/a A/b A/c");
+    ini.AddValue("A", "d", 4);
+    CHECK(section_a.size() == 3 && section_a.back() == "A/d");
+    CHECK_THROWS(ini.EndBatch(), IniException);
+
+    // The error path leaves an outer batch running.
+    ini.BeginBatch();
+    CHECK_THROWS(ini.LoadFromString("[A]\na = 10\n[Broken\n"), IniException);
+    CHECK(section_a.size() == 3);
+    ini.EndBatch();
+    CHECK(section_a.size() == 4 && section_a.back() == "A/a A/b A/d");
+}
+
+void TestUnsubscribe()
+{
+    IniBuffer ini;
+    std::vector<std::string> first;
+    std::vector<std::string> second;
+    const IniBufferBase::SubscriptionId first_id = ini.Subscribe("A", "a", RecordChanges(first));
+    ini.Subscribe("A", "a", RecordChanges(second));
+    ini.AddValue("A", "a", 1);
+    CHECK(first.size() == 1 && second.size() == 1);
+
+    ini.Unsubscribe(first_id);
+    ini.Unsubscribe(first_id);
+    ini.Unsubscribe(12345);
+    ini.AddValue("A", "a", 2);
+    ini.LoadFromString("[A]\na = 3\n");
+    CHECK(first.size() == 1);
+    CHECK(second.size() == 3);
+}
+
+void TestFreezeManyEntries()
+{
+    IniBuffer ini;
+    for(int section = 0; section < 100; ++section)
+    {
+        for(int key = 0; key < 200; ++key)
+        {
+            ini.AddValue("s" + std::to_string(section), "k" + std::to_string(key), section*1000 + key);
+        }
+    }
+
+    const FrozenIni frozen = ini.Freeze();
+    CHECK(frozen.GetPropertyCount() == 20000);
+    bool all_found = true;
+    for(int section = 0; section < 100; ++section)
+    {
+        for(int key = 0; key < 200; ++key)
+        {
+            all_found = all_found && frozen.GetValue<int>("s" + std::to_string(section), "k" + std::to_string(key)) == section*1000 + key;
+        }
+    }
+    CHECK(all_found);
+    CHECK(!frozen.HasValue("s0", "k200"));
+}
+
+void TestProfileGuidedFreeze()
+{
+    IniBuffer ini;
+    for(int section = 0; section < 20; ++section)
+    {
+        for(int key = 0; key < 20; ++key)
+        {
+            ini.AddValue("s" + std::to_string(section), "k" + std::to_string(key), "v" + std::to_string(section*100 + key));
+        }
+    }
+    ini.AddValue("Numbers", "count", 42);
+    ini.AddValue("Numbers", "ratio", 0.25f);
+    ini.AddValue("Numbers", "long", std::string(200, 'x'));
+
+    ini.EnableAccessProfiling();
+    for(int i = 0; i < 5; ++i)
+    {
+        ini.GetStringRef("s7", "k3");
+    }
+    for(int i = 0; i < 3; ++i)
+    {
+        ini.GetValue<int>("Numbers", "count");
+        ini.GetStringRef("s19", "k0");
+    }
+    ini.GetStringRef("s0", "k19");
+    ini.GetStringRef("Numbers", "long");
+    const IniBufferBase::AccessReport report = ini.GetAccessReport();
+    const FrozenIni plain = ini.Freeze();
+    const FrozenIni profiled = ini.Freeze(report);
+
+    // Every key resolves to the same value.
+    CHECK(profiled.GetPropertyCount() == plain.GetPropertyCount());
+    CHECK(profiled.GetSectionCount() == plain.GetSectionCount());
+    bool all_equal = true;
+    for(int section = 0; section < 20; ++section)
+    {
+        for(int key = 0; key < 20; ++key)
+        {
+            const std::string section_name = "s" + std::to_string(section);
+            const std::string key_name = "k" + std::to_string(key);
+            all_equal = all_equal && profiled.GetValue<std::string>(section_name, key_name) == plain.GetValue<std::string>(section_name, key_name);
+        }
+    }
+    CHECK(all_equal);
+    CHECK(profiled.GetValue<int>("Numbers", "count") == 42);
+    CHECK(profiled.GetValue<float>("Numbers", "ratio") == 0.25f);
+    CHECK(profiled.GetValue<std::string>("Numbers", "long") == std::string(200, 'x'));
+    CHECK(!profiled.HasValue("s20", "k0"));
+
+    // The values of the hot keys come first in the string region, the most frequently read first.
+    // Without a profile the map order puts s0 first.
+    const char* hottest = profiled.GetStringView("s7", "k3").data();
+    const char* second = profiled.GetStringView("s19", "k0").data();
+    const char* third = profiled.GetStringView("s0", "k19").data();
+    CHECK(hottest < second && second < third);
+    CHECK(plain.GetStringView("s0", "k19").data() < plain.GetStringView("s7", "k3").data());
+    bool cold_follow = true;
+    for(int key = 0; key < 20; ++key)
+    {
+        cold_follow = cold_follow && profiled.GetStringView("s1", "k" + std::to_string(key)).data() > third;
+    }
+    CHECK(cold_follow);
+
+    // Long values are stored behind all short ones, even if they are hot.
+    CHECK(profiled.GetStringView("Numbers", "long").data() > profiled.GetStringView("s1", "k0").data());
+}
+
+void TestPublishAndMap()
+{
+#ifdef FROZEN_INI_POSIX
+    const std::string fullfilename = "results/published.img";
+    std::remove(fullfilename.c_str());
+    CHECK(FrozenIni::GetPublishedVersion(fullfilename) == 0);
+
+    IniBuffer ini;
+    ini.LoadFromString("[A]\na = 1\nname = first\n[B]\nratio = 0.5\n");
+    const FrozenIni frozen = ini.Freeze();
+    CHECK(frozen.GetVersion() == 0);
+    CHECK(frozen.Publish(fullfilename) == 1);
+    CHECK(FrozenIni::GetPublishedVersion(fullfilename) == 1);
+
+    const FrozenIni mapped = FrozenIni::Map(fullfilename);
+    CHECK(mapped.GetVersion() == 1);
+    CHECK(mapped.GetPropertyCount() == 3);
+    CHECK(mapped.GetSectionCount() == 2);
+    CHECK(mapped.GetValue<int>("A", "a") == 1);
+    CHECK(mapped.GetValue<std::string>("A", "name") == "first");
+    CHECK(mapped.GetValue<float>("B", "ratio") == 0.5f);
+    CHECK(!mapped.HasValue("B", "a"));
+
+    // Every publish increments the version. A mapping keeps the image it mapped until it is mapped again.
+    ini.AddValue("A", "name", std::string("second"));
+    CHECK(ini.Freeze().Publish(fullfilename) == 2);
+    CHECK(frozen.Publish(fullfilename) == 3);
+    ini.AddValue("A", "name", std::string("third"));
+    CHECK(ini.Freeze().Publish(fullfilename) == 4);
+    CHECK(FrozenIni::GetPublishedVersion(fullfilename) == 4);
+    CHECK(mapped.GetVersion() == 1);
+    CHECK(mapped.GetValue<std::string>("A", "name") == "first");
+
+    const FrozenIni remapped = FrozenIni::Map(fullfilename);
+    CHECK(remapped.GetVersion() == 4);
+    CHECK(remapped.GetValue<std::string>("A", "name") == "third");
+#endif
+}
+
+void TestMapRejectsInvalidImages()
+{
+#ifdef FROZEN_INI_POSIX
+    CHECK_THROWS(FrozenIni::Map("results/missing.img"), IniException);
+
+    // Shorter than a header and longer than a header.
+    WriteTextFile("results/short.img", "[A]\na = 1\n");
+    CHECK_THROWS(FrozenIni::Map("results/short.img"), IniException);
+    CHECK_THROWS(FrozenIni::GetPublishedVersion("results/short.img"), IniException);
+    WriteTextFile("results/text.img", std::string(4096, 'x'));
+    CHECK_THROWS(FrozenIni::Map("results/text.img"), IniException);
+    CHECK_THROWS(FrozenIni::GetPublishedVersion("results/text.img"), IniException);
+
+    IniBuffer ini;
+    ini.LoadFromString("[A]\na = 1\nname = first\n[B]\nratio = 0.5\n");
+    ini.Freeze().Publish("results/valid.img");
+    const std::string image = ReadTextFile("results/valid.img");
+    CHECK(FrozenIni::Map("results/valid.img").GetValue<int>("A", "a") == 1);
+
+    // Cut inside the tables, cut off the last byte and appended garbage.
+    WriteTextFile("results/truncated.img", image.substr(0, image.size()/2));
+    CHECK_THROWS(FrozenIni::Map("results/truncated.img"), IniException);
+    WriteTextFile("results/truncated.img", image.substr(0, image.size() - 1));
+    CHECK_THROWS(FrozenIni::Map("results/truncated.img"), IniException);
+    WriteTextFile("results/truncated.img", image + "garbage");
+    CHECK_THROWS(FrozenIni::Map("results/truncated.img"), IniException);
+#endif
+}
+
+void TestEraseMissing()
+{
+    IniBuffer ini;
+    ini.LoadFromString("[A]\na = 1\n");
+    int notifications = 0;
+    ini.Subscribe("A", "*", [&](const std::vector<IniBufferBase::Change>&){++notifications;});
+
+    ini.EraseProperty("Missing", "a");
+    ini.EraseProperty("A", "missing");
+    ini.EraseSection("Missing");
+    CHECK(notifications == 0);
+    CHECK(ini.GetValue<int>("A", "a") == 1);
+
+    ini.EraseProperty("A", "a");
+    CHECK(notifications == 1);
+    CHECK_THROWS(ini.GetStringRef("A", "a"), IniException);
+}
+
+template<typename BufferT>
+void CheckStableReferences()
+{
+    static_assert(BufferT::StoragePolicy_t::stable_references, "Only storages with stable references are checked.");
+
+    BufferT ini;
+    ini.LoadFromString("[M]\nvalue = middle\n");
+    const std::string& value = ini.GetStringRef("M", "value");
+    for(int i = 0; i < 1000; ++i)
+    {
+        ini.AddValue("M", "k" + std::to_string(i), i);
+        ini.AddValue("S" + std::to_string(i), "k", i);
+    }
+    CHECK(&value == &ini.GetStringRef("M", "value"));
+    CHECK(value == "middle");
+}
+
+void TestStableReferences()
+{
+    CheckStableReferences<IniBuffer>();
+    CheckStableReferences<BasicIniBuffer<HashedStorage>>();
+    static_assert(!SortedVectorStorage::stable_references, "Sorted vectors move their items.");
+}
+
+void TestParallelWriteMatchesSerial()
+{
+    // About 12 MB in many sections, so the content is split into several chunks.
+    IniBuffer ini;
+    const std::string value(80, 'v');
+    for(int section = 0; section < 3000; ++section)
+    {
+        for(int key = 0; key < 40; ++key)
+        {
+            ini.AddValue("section " + std::to_string(section), "key" + std::to_string(key), value + std::to_string(section*key));
+        }
+    }
+    CHECK(ini.WriteToString().size() >= 8*1024*1024);
+
+    ini.WriteFile("results/serial.ini", false, 1);
+    ini.WriteFile("results/parallel.ini", false, 4);
+    const std::string serial = ReadTextFile("results/serial.ini");
+    CHECK(serial == ini.WriteToString());
+    CHECK(ReadTextFile("results/parallel.ini") == serial);
+
+    // Small content is written by the calling thread with the same result.
+    IniBuffer small;
+    small.LoadFromString("[A]\na = 1\n[B]\nb = 2\n");
+    small.WriteFile("results/small.ini", false, 4);
+    CHECK(ReadTextFile("results/small.ini") == small.WriteToString());
+
+    std::remove("results/serial.ini");
+    std::remove("results/parallel.ini");
+    std::remove("results/small.ini");
+}
+
+/// Loads a file, applies a change, saves it and returns the saved content.
+template<typename FunctionT>
+std::string SaveChange(const std::string& content, FunctionT change)
+{
+    const std::string fullfilename = "results/save_test.ini";
+    WriteTextFile(fullfilename, content);
+    IniBuffer ini;
+    ini.LoadFile(fullfilename);
+    change(ini);
+    ini.Save();
+    const std::string saved = ReadTextFile(fullfilename);
+    std::remove(fullfilename.c_str());
+    return saved;
+}
+
+void TestSaveInlineComments()
+{
+    // An inline comment on the last property line belongs to that line.
+    CHECK(SaveChange("[A]\na = 1\nb = 2 ; inline\n\n[B]\nc = 3\n", [](IniBuffer& ini)
+    {
+        ini.AddValue("A", "b", std::string("twenty"));
+    }) == "[A]\na = 1\nb = twenty\n\n[B]\nc = 3\n");
+
+    // An inline comment on the header line does not end the section.
+    CHECK(SaveChange("; file\n[A] ; header\na = 1\n\n; about B\n[B]\nc = 3\n", [](IniBuffer& ini)
+    {
+        ini.AddValue("A", "a", 10);
+    }) == "; file\n[A]\na = 10\n\n; about B\n[B]\nc = 3\n");
+
+    // Unchanged sections keep their inline comments.
+    CHECK(SaveChange("[A]\na = 1 ; one\n[B] ; bee\nc = 3 ; three\n", [](IniBuffer& ini)
+    {
+        ini.AddValue("B", "c", 30);
+    }) == "[A]\na = 1 ; one\n[B]\nc = 30\n\n");
+}
+
+void TestSaveMissingFinalLineBreak()
+{
+    CHECK(SaveChange("[A]\na = 1", [](IniBuffer& ini)
+    {
+        ini.AddValue("B", "b", 2);
+    }) == "[A]\na = 1\n[B]\nb = 2\n\n");
+
+    CHECK(SaveChange("[A]\na = 1\n; end", [](IniBuffer& ini)
+    {
+        ini.AddValue("B", "b", 2);
+    }) == "[A]\na = 1\n; end\n[B]\nb = 2\n\n");
+
+    // Saving twice appends behind the line break added by the first save.
+    const std::string fullfilename = "results/save_test.ini";
+    WriteTextFile(fullfilename, "[A]\na = 1");
+    IniBuffer ini;
+    ini.LoadFile(fullfilename);
+    ini.AddValue("B", "b", 2);
+    ini.Save();
+    ini.AddValue("C", "c", 3);
+    ini.Save();
+    CHECK(ReadTextFile(fullfilename) == "[A]\na = 1\n[B]\nb = 2\n\n[C]\nc = 3\n\n");
+    std::remove(fullfilename.c_str());
+}
+
+void TestSaveDetectsQuickModification()
+{
+    // A modification of the same size within the same second is detected by the nanoseconds of the stamp.
+    const std::string fullfilename = "results/save_test.ini";
+    WriteTextFile(fullfilename, "[A]\na = 1\n");
+    IniBuffer ini;
+    ini.LoadFile(fullfilename);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    WriteTextFile(fullfilename, "[A]\na = 2\n");
+    ini.AddValue("A", "b", 3);
+    CHECK_THROWS(ini.Save(), IniException);
+    CHECK(ReadTextFile(fullfilename) == "[A]\na = 2\n");
+    std::remove(fullfilename.c_str());
+}
+
+/// Returns the count of a key in a list of the access report, or -1 if it is not listed.
+int64_t FindCount(const std::vector<IniBufferBase::AccessCount>& counts, const std::string& section_name, const std::string& key_name)
+{
+    for(const IniBufferBase::AccessCount& count : counts)
+    {
+        if(count.section_name == section_name && count.key_name == key_name)
+        {
+            return static_cast<int64_t>(count.count);
+        }
+    }
+    return -1;
+}
+
+template<typename BufferT>
+void CheckAccessProfiling()
+{
+    BufferT ini;
+    ini.LoadFromString("[A]\nb = two\nd = 4\nunread = 0\n");
+    ini.EnableAccessProfiling();
+    for(int i = 0; i < 3; ++i)
+    {
+        ini.template GetValue<int>("A", "d");
+    }
+    ini.GetStringRef("A", "b");
+    CHECK_THROWS(ini.GetStringRef("A", "missing"), IniException);
+
+    // Overwriting keeps the count, values moved by inserting other keys take their counts along.
+    ini.AddValue("A", "d", 40);
+    ini.AddValue("A", "a", 1);
+    ini.AddValue("A", "c", 3);
+    CHECK(ini.template GetValue<int>("A", "d") == 40);
+
+    IniBufferBase::AccessReport report = ini.GetAccessReport();
+    CHECK(report.hot_keys.size() == 2);
+    CHECK(report.hot_keys.size() == 2 && report.hot_keys[0].key_name == "d");
+    CHECK(FindCount(report.hot_keys, "A", "d") == 4);
+    CHECK(FindCount(report.hot_keys, "A", "b") == 1);
+    CHECK(FindCount(report.unread_keys, "A", "unread") == 0);
+    CHECK(FindCount(report.unread_keys, "A", "a") == 0);
+    CHECK(FindCount(report.missing_keys, "A", "missing") == 1);
+
+    // Enabling again discards the counts.
+    ini.EnableAccessProfiling();
+    report = ini.GetAccessReport();
+    CHECK(report.hot_keys.empty() && report.missing_keys.empty());
+    CHECK(report.unread_keys.size() == 5);
+}
+
+void TestAccessProfiling()
+{
+    CheckAccessProfiling<IniBuffer>();
+    CheckAccessProfiling<BasicIniBuffer<SortedVectorStorage>>();
+}
+
+int main()
+{
+    RunTest("ReaderEvents", TestReaderEvents);
+    RunTest("ReaderChunks", TestReaderChunks);
+    RunTest("ReaderErrors", TestReaderErrors);
+    RunTest("RepeatedSectionsAreMerged", TestRepeatedSectionsAreMerged);
+    RunTest("IncludedSectionsAreMerged", TestIncludedSectionsAreMerged);
+    RunTest("LoadReplacesExistingSections", TestLoadReplacesExistingSections);
+    RunTest("IncludeBaseDirectory", TestIncludeBaseDirectory);
+    RunTest("AdoptLoadedBuffer", TestAdoptLoadedBuffer);
+    RunTest("CacheReusesUnchangedFiles", TestCacheReusesUnchangedFiles);
+    RunTest("CacheEvictsLeastRecentlyUsed", TestCacheEvictsLeastRecentlyUsed);
+    RunTest("CacheFollowsIncludedFiles", TestCacheFollowsIncludedFiles);
+    RunTest("WriteToMemoryRoundTrip", TestWriteToMemoryRoundTrip);
+    RunTest("WriteToBufferReuse", TestWriteToBufferReuse);
+    RunTest("WriteToFailedStream", TestWriteToFailedStream);
+    RunTest("CStringOverloads", TestCStringOverloads);
+    RunTest("NestedCStringLookups", TestNestedCStringLookups);
+    RunTest("BatchCoalescesChanges", TestBatchCoalescesChanges);
+    RunTest("LoadNotifiesSubscribers", TestLoadNotifiesSubscribers);
+    RunTest("Unsubscribe", TestUnsubscribe);
+    RunTest("FreezeManyEntries", TestFreezeManyEntries);
+    RunTest("ProfileGuidedFreeze", TestProfileGuidedFreeze);
+    RunTest("PublishAndMap", TestPublishAndMap);
+    RunTest("MapRejectsInvalidImages", TestMapRejectsInvalidImages);
+    RunTest("AccessProfiling", TestAccessProfiling);
+    RunTest("EraseMissing", TestEraseMissing);
+    RunTest("StableReferences", TestStableReferences);
+    RunTest("ParallelWriteMatchesSerial", TestParallelWriteMatchesSerial);
+    RunTest("SaveInlineComments", TestSaveInlineComments);
+    RunTest("SaveMissingFinalLineBreak", TestSaveMissingFinalLineBreak);
+    RunTest("SaveDetectsQuickModification", TestSaveDetectsQuickModification);
+    return failed_checks;
+}
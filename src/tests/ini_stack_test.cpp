@@ -0,0 +1,110 @@
+/**
+ * @file ini_stack_test.cpp
+ * @author Pascal Enderli
+ * @date 2026.10.18
+ * @brief Tests of the layer precedence and the resolution index of IniStack.
+ */
+
+#include"ini_stack.h"
+#include"test_util.h"
+
+/// Returns a buffer parsed from ini content.
+IniBuffer MakeBuffer(const std::string& content)
+{
+    IniBuffer buffer;
+    buffer.LoadFromString(content);
+    return buffer;
+}
+
+void TestLookupPrecedence()
+{
+    IniStack stack;
+    CHECK(stack.PushLayer(MakeBuffer("[net]\nport = 80\nhost = defaults\n[log]\nlevel = info\n")) == 0);
+    CHECK(stack.PushLayer(MakeBuffer("[net]\nport = 8080\n")) == 1);
+    CHECK(stack.PushLayer(MakeBuffer("[log]\nlevel = debug\n")) == 2);
+
+    CHECK(stack.GetLayerCount() == 3);
+    CHECK(stack.GetValue<int>("net", "port") == 8080);
+    CHECK(stack.GetSourceLayer("net", "port") == 1);
+    CHECK(stack.GetValue<std::string>("net", "host") == "defaults");
+    CHECK(stack.GetSourceLayer("net", "host") == 0);
+    CHECK(stack.GetStringRef("log", "level") == "debug");
+    CHECK(stack.GetSourceLayer("log", "level") == 2);
+
+    CHECK(!stack.HasValue("net", "timeout"));
+    CHECK_THROWS(stack.GetValue<int>("net", "timeout"), IniException);
+    CHECK_THROWS(stack.GetSourceLayer("dns", "port"), IniException);
+    CHECK_THROWS(stack.GetLayer(3), IniException);
+}
+
+void TestReplaceLayer()
+{
+    IniStack stack;
+    stack.PushLayer(MakeBuffer("[net]\nport = 80\n"));
+    stack.PushLayer(MakeBuffer("[net]\nport = 8080\n"));
+    stack.PushLayer(MakeBuffer("[log]\nlevel = debug\n"));
+
+    // A lower layer does not shadow a higher one.
+    stack.ReplaceLayer(0, MakeBuffer("[net]\nport = 81\ntimeout = 5\n"));
+    CHECK(stack.GetValue<int>("net", "port") == 8080);
+    CHECK(stack.GetValue<int>("net", "timeout") == 5);
+    CHECK(stack.GetSourceLayer("net", "timeout") == 0);
+
+    // A new key of a higher layer shadows the lower one.
+    stack.ReplaceLayer(2, MakeBuffer("[net]\ntimeout = 10\n"));
+    CHECK(stack.GetValue<int>("net", "timeout") == 10);
+    CHECK(stack.GetSourceLayer("net", "timeout") == 2);
+    CHECK(!stack.HasValue("log", "level"));
+
+    CHECK_THROWS(stack.ReplaceLayer(3, IniBuffer()), IniException);
+    CHECK(stack.GetLayerCount() == 3);
+}
+
+void TestRemovedKeys()
+{
+    IniStack stack;
+    stack.PushLayer(MakeBuffer("[net]\nport = 80\n"));
+    stack.PushLayer(MakeBuffer("[net]\nport = 8080\nhost = site\n"));
+
+    // A key removed from the top layer falls back to the layer below.
+    stack.ReplaceLayer(1, MakeBuffer("[net]\nhost = site\n"));
+    CHECK(stack.GetValue<int>("net", "port") == 80);
+    CHECK(stack.GetSourceLayer("net", "port") == 0);
+
+    // A key removed from all layers is not resolved anymore.
+    stack.ReplaceLayer(0, IniBuffer());
+    CHECK(!stack.HasValue("net", "port"));
+    CHECK_THROWS(stack.GetStringRef("net", "port"), IniException);
+    CHECK(stack.GetValue<std::string>("net", "host") == "site");
+
+    stack.Clear();
+    CHECK(stack.GetLayerCount() == 0);
+    CHECK(!stack.HasValue("net", "host"));
+}
+
+void TestFailedReloadKeepsState()
+{
+    const std::string fullfilename = "results/ini_stack_test.ini";
+    WriteTextFile(fullfilename, "[net]\nport = 9000\n");
+
+    IniStack stack;
+    stack.PushLayer(MakeBuffer("[net]\nport = 80\n"));
+    stack.PushLayer(IniBuffer());
+    stack.ReloadLayer(1, fullfilename);
+    CHECK(stack.GetValue<int>("net", "port") == 9000);
+
+    WriteTextFile(fullfilename, "[net\nport = 9001\n");
+    CHECK_THROWS(stack.ReloadLayer(1, fullfilename), IniException);
+    CHECK(stack.GetValue<int>("net", "port") == 9000);
+    CHECK(stack.GetLayer(1).GetValue<int>("net", "port") == 9000);
+    std::remove(fullfilename.c_str());
+}
+
+int main()
+{
+    RunTest("LookupPrecedence", TestLookupPrecedence);
+    RunTest("ReplaceLayer", TestReplaceLayer);
+    RunTest("RemovedKeys", TestRemovedKeys);
+    RunTest("FailedReloadKeepsState", TestFailedReloadKeepsState);
+    return failed_checks;
+}
@@ -0,0 +1,237 @@
+"""Runtime tests of the IniBuffer python binding.
+
+Run from the python_interface folder of the build, where the IniBuffer module is located.
+"""
+
+import array
+import mmap
+import os
+import sys
+import tempfile
+import threading
+import unittest
+
+sys.path.insert(0, os.getcwd())
+from IniBuffer import IniBuffer
+
+CONTENT = "[Circle]\nDiameter = 700\nColor = red\nhas_edges = false\nRatio = 0.5\n\n[Square]\nmaterial = wood\n"
+
+
+class LoadTest(unittest.TestCase):
+    def test_load_bytes(self):
+        for content in (CONTENT.encode(), bytearray(CONTENT.encode()), memoryview(CONTENT.encode())):
+            ini = IniBuffer()
+            ini.LoadBytes(content)
+            self.assertEqual(ini.get("Circle", "Diameter"), 700)
+
+    def test_load_mmap(self):
+        with tempfile.TemporaryDirectory() as directory:
+            fullfilename = os.path.join(directory, "mapped.ini")
+            with open(fullfilename, "w") as file:
+                file.write(CONTENT)
+            with open(fullfilename, "rb") as file:
+                mapped = mmap.mmap(file.fileno(), 0, access=mmap.ACCESS_READ)
+                ini = IniBuffer()
+                ini.LoadBytes(mapped)
+                mapped.close()
+            self.assertEqual(ini.get("Square", "material"), "wood")
+
+    def test_load_string(self):
+        ini = IniBuffer()
+        ini.LoadString(CONTENT.replace("red", "röt"))
+        self.assertEqual(ini.get("Circle", "Color"), "röt")
+
+    def test_invalid_content_raises(self):
+        with self.assertRaises(RuntimeError):
+            IniBuffer().LoadString("[Circle\n")
+
+    def test_loads_in_threads(self):
+        errors = []
+
+        def load():
+            try:
+                ini = IniBuffer()
+                for _ in range(50):
+                    ini.LoadString(CONTENT)
+            except Exception as error:
+                errors.append(error)
+
+        threads = [threading.Thread(target=load) for _ in range(4)]
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+        self.assertEqual(errors, [])
+
+    def test_modify_while_loading(self):
+        content = "".join("[Section{0}]\nvalue = {0}\nname = section{0}\n".format(i) for i in range(2000))
+        errors = []
+        ini = IniBuffer()
+
+        def load():
+            try:
+                for _ in range(20):
+                    ini.LoadFile(source)
+                    ini.LoadString(content)
+                    ini.LoadBytes(content.encode())
+            except Exception as error:
+                errors.append(error)
+
+        with tempfile.TemporaryDirectory() as directory:
+            source = os.path.join(directory, "source.ini")
+            with open(source, "w") as file:
+                file.write(content)
+            fullfilename = os.path.join(directory, "written.ini")
+            thread = threading.Thread(target=load)
+            thread.start()
+            while thread.is_alive():
+                ini.set("Section1", "value", 2)
+                ini.set("Added", "value", 3)
+                ini.EraseSection("Section2")
+                ini.EraseProperty("Added", "value")
+                ini.Clear()
+                ini.WriteFile(fullfilename, False, 2)
+            thread.join()
+            self.assertEqual(errors, [])
+            ini.LoadFile(source)
+        self.assertEqual(ini.get("Section1999", "value"), 1999)
+
+
+class ValueTest(unittest.TestCase):
+    def setUp(self):
+        self.ini = IniBuffer()
+        self.ini.LoadString(CONTENT)
+
+    def test_get_typed(self):
+        self.assertEqual(self.ini.get("Circle", "Diameter"), 700)
+        self.assertIs(self.ini.get("Circle", "has_edges"), False)
+        self.assertEqual(self.ini.get("Circle", "Ratio"), 0.5)
+        self.assertEqual(self.ini.get("Circle", "Color"), "red")
+
+    def test_set_round_trip(self):
+        for value in (800, True, "blue", 0.5, 0.1, 1e-9, -2.5e-300, 123456789.125, 2.0**60 + 0.5, 1e300):
+            self.ini.set("Circle", "Value", value)
+            self.assertEqual(self.ini.get("Circle", "Value"), value)
+
+    def test_add_value_float_round_trip(self):
+        for value in (0.1, 1e-9, 123456789.125):
+            self.ini.AddValue("Circle", "Value", value)
+            self.assertEqual(self.ini.GetValue_float("Circle", "Value"), value)
+
+    def test_get_many(self):
+        self.assertEqual(self.ini.get_many("Circle", ["Diameter", "Color", "Radius"]), [700, "red", None])
+        self.assertEqual(self.ini.get_many([("Circle", "Diameter"), ("Square", "material")], default=0), [700, "wood"])
+
+    def test_dicts(self):
+        self.assertEqual(self.ini.section_dict("Square"), {"material": "wood"})
+        self.assertEqual(set(self.ini.to_dict()), {"Circle", "Square"})
+
+
+class ArrayTest(unittest.TestCase):
+    def setUp(self):
+        self.ini = IniBuffer()
+        self.ini.LoadString("[Data]\nx0 = 1.5\nx1 = -2\nx2 = text\ny0 = 4\n")
+
+    def test_export_array(self):
+        keys = self.ini.get_array_keys("Data", "x*")
+        self.assertEqual(keys, ["x0", "x1"])
+        out = array.array("d", [0.0]*len(keys))
+        self.assertEqual(self.ini.export_array("Data", out, "x*"), 2)
+        self.assertEqual(list(out), [1.5, -2.0])
+
+    def test_export_array_wrong_size_raises(self):
+        with self.assertRaises(ValueError):
+            self.ini.export_array("Data", array.array("d", [0.0]), "x*")
+        with self.assertRaises(ValueError):
+            self.ini.export_array("Data", array.array("q", [0]*3), "y*")
+
+    def test_failed_export_leaves_output_untouched(self):
+        out = array.array("q", [7, 7])
+        with self.assertRaises(RuntimeError):
+            self.ini.export_array("Data", out, "x*")
+        self.assertEqual(list(out), [7, 7])
+
+        self.ini.LoadString("[Data]\nx0 = 1\nx1 = 99999999999999999999\n")
+        with self.assertRaises(RuntimeError):
+            self.ini.export_array("Data", out, "x*")
+        self.assertEqual(list(out), [7, 7])
+
+    def test_set_array_round_trip(self):
+        values = array.array("d", [0.1, 1e-12, 12345.678901234567])
+        self.ini.set_array("Calibration", ["a", "b", "c"], values)
+        out = array.array("d", [0.0]*3)
+        self.ini.export_array("Calibration", out)
+        self.assertEqual(list(out), list(values))
+
+    def test_get_array(self):
+        try:
+            import numpy
+        except ImportError:
+            self.skipTest("numpy is not installed")
+        self.assertEqual(list(self.ini.get_array("Data", "x*")), [1.5, -2.0])
+        self.assertEqual(self.ini.get_array("Data", "y*", dtype="int64").dtype, numpy.int64)
+
+
+class MappingTest(unittest.TestCase):
+    def setUp(self):
+        self.ini = IniBuffer()
+        self.ini.LoadString(CONTENT)
+
+    def test_sections(self):
+        self.assertEqual(sorted(self.ini), ["Circle", "Square"])
+        self.assertEqual(len(self.ini), 2)
+        self.assertIn("Circle", self.ini)
+        with self.assertRaises(KeyError):
+            self.ini["Triangle"]
+
+    def test_section_view(self):
+        circle = self.ini["Circle"]
+        self.assertEqual(circle["Diameter"], 700)
+        circle["Diameter"] = 800
+        self.assertEqual(self.ini.get("Circle", "Diameter"), 800)
+        self.assertIn("Color", circle)
+        del circle["Color"]
+        self.assertNotIn("Color", circle)
+        with self.assertRaises(KeyError):
+            circle["Color"]
+        self.assertEqual(circle.get("Color", 1), 1)
+
+    def test_view_keeps_buffer_alive(self):
+        square = IniBuffer()
+        square.LoadString(CONTENT)
+        view = square["Square"]
+        del square
+        self.assertEqual(view["material"], "wood")
+
+    def test_delete_section(self):
+        del self.ini["Square"]
+        self.assertNotIn("Square", self.ini)
+        with self.assertRaises(KeyError):
+            del self.ini["Square"]
+
+
+class FileTest(unittest.TestCase):
+    def test_write_and_save(self):
+        with tempfile.TemporaryDirectory() as directory:
+            fullfilename = os.path.join(directory, "shapes.ini")
+            with open(fullfilename, "w") as file:
+                file.write("; shapes\n" + CONTENT)
+            ini = IniBuffer()
+            ini.LoadFile(fullfilename)
+            self.assertFalse(ini.IsDirty())
+            ini["Circle"]["Diameter"] = 800
+            self.assertTrue(ini.IsDirty())
+            ini.Save()
+            self.assertFalse(ini.IsDirty())
+            with open(fullfilename) as file:
+                self.assertTrue(file.read().startswith("; shapes\n"))
+
+            copy = os.path.join(directory, "copy.ini")
+            ini.WriteFile(copy, False, 2)
+            loaded = IniBuffer()
+            loaded.LoadFile(copy)
+            self.assertEqual(loaded.to_dict(), ini.to_dict())
+
+
+if __name__ == "__main__":
+    unittest.main()
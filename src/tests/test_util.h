@@ -0,0 +1,60 @@
+/**
+ * @file test_util.h
+ * @author Pascal Enderli
+ * @date 2026.10.18
+ * @brief Minimal checks for the test executables. Every test executable returns the number of failed checks.
+ */
+
+#ifndef TEST_UTIL_H_
+#define TEST_UTIL_H_
+
+#include<fstream>
+#include<functional>
+#include<iostream>
+#include<sstream>
+#include<string>
+
+/// Number of failed checks of the test executable.
+static int failed_checks = 0;
+
+/// Reports a failed check with its location.
+#define CHECK(condition) \
+    do{ if(!(condition)){ ++failed_checks; std::cerr<<__FILE__<<":"<<__LINE__<<": Check failed: "<<#condition<<'\n'; } }while(false)
+
+/// Checks that a statement throws an exception of the given type.
+#define CHECK_THROWS(statement, ExceptionT) \
+    do{ bool is_thrown = false; try{ statement; } catch(ExceptionT&){ is_thrown = true; } catch(...){} \
+        if(!is_thrown){ ++failed_checks; std::cerr<<__FILE__<<":"<<__LINE__<<": Expected "<<#ExceptionT<<" from: "<<#statement<<'\n'; } }while(false)
+
+/// Runs one test case. Unexpected exceptions are reported as failed check.
+inline void RunTest(const std::string& name, const std::function<void()>& test)
+{
+    const int failed_before = failed_checks;
+    try
+    {
+        test();
+    }
+    catch(std::exception& e)
+    {
+        ++failed_checks;
+        std::cerr<<name<<": Unexpected exception: "<<e.what()<<'\n';
+    }
+    std::cout<<(failed_checks == failed_before ? "[  OK  ] " : "[FAILED] ")<<name<<'\n';
+}
+
+/// Returns the whole content of a file.
+inline std::string ReadTextFile(const std::string& fullfilename)
+{
+    std::ifstream file(fullfilename, std::ios::in | std::ios::binary);
+    std::stringstream content;
+    content<<file.rdbuf();
+    return content.str();
+}
+
+/// Replaces the content of a file.
+inline void WriteTextFile(const std::string& fullfilename, const std::string& content)
+{
+    std::ofstream file(fullfilename, std::ios::out | std::ios::binary | std::ios::trunc);
+    file<<content;
+}
+#endif